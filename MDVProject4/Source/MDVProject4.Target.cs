@@ -11,5 +11,14 @@ public class MDVProject4Target : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
 		ExtraModuleNames.Add("MDVProject4");
+
+		// Set MDV_PROFILE_SHIPPING=1 to keep the MDVProject4 stats group and trace channel in Shipping builds.
+		// Changing global definitions needs a unique build environment, so this requires a source build of the engine
+		if (Target.Configuration == UnrealTargetConfiguration.Shipping && System.Environment.GetEnvironmentVariable("MDV_PROFILE_SHIPPING") == "1")
+		{
+			BuildEnvironment = TargetBuildEnvironment.Unique;
+			GlobalDefinitions.Add("FORCE_USE_STATS=1");
+			GlobalDefinitions.Add("UE_TRACE_ENABLED=1");
+		}
 	}
 }
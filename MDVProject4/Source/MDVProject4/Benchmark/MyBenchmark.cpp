@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyBenchmark.h"
+
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "HAL/IConsoleManager.h"
+#include "Dom/JsonObject.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/EngineVersion.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "MDVProject4/Controller/AMyController.h"
+#include "MDVProject4/Controller/MyFrameScheduler.h"
+#include "MDVProject4/Controller/MyTextureUploader.h"
+#include "MDVProject4/Controller/MyReferenceManager.h"
+#include "MDVProject4/Controller/MyWorldRegistry.h"
+#include "MDVProject4/Objects/AMyActor.h"
+#include "MDVProject4/UI/HUD/MyHUD.h"
+#include "MDVProject4/Utils/Defines.h"
+#include "MDVProject4/Utils/MyStats.h"
+
+static FAutoConsoleCommandWithWorldAndArgs RunBenchmarkCommand(
+	TEXT("MDV.Benchmark.Run"),
+	TEXT("Benchmarks the tile pipeline on a synthetic library and writes a report to Saved/Benchmarks. ")
+	TEXT("Usage: MDV.Benchmark.Run [Tiles=200] [Size=512] [Format=png|jpg] [Walls=400] [Storm=100] [Lookups=100000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FMyBenchmark::Run));
+
+
+/**
+ * Runs the whole benchmark and restores the controller, the HUD and the save slot to their previous state afterwards
+ * @param Args Console arguments, see the command help
+ * @param World World the controller lives in
+ */
+void FMyBenchmark::Run(const TArray<FString>& Args, UWorld* World) {
+	// The spawned walls are picked up by the controller through the world registry
+	AMyController* MyController = UMyWorldRegistry::Get(World)->GetController();
+	if (!MyController || !AMyController::MyReferenceManager) {
+		UE_LOG(LogTemp, Error, TEXT("MDV.Benchmark.Run needs a level with an AMyController and an AMyReferenceManager"));
+		return;
+	}
+	AMyHUD* MyHUD = AMyController::MyReferenceManager->MyHUD;
+	
+	FSettings Settings;
+	const FString CommandLine = FString::Join(Args, TEXT(" "));
+	FParse::Value(*CommandLine, TEXT("Tiles="), Settings.TileCount);
+	FParse::Value(*CommandLine, TEXT("Size="), Settings.TileSize);
+	FParse::Value(*CommandLine, TEXT("Format="), Settings.Format);
+	FParse::Value(*CommandLine, TEXT("Walls="), Settings.WallCount);
+	FParse::Value(*CommandLine, TEXT("Storm="), Settings.StormSize);
+	FParse::Value(*CommandLine, TEXT("Lookups="), Settings.LookupCount);
+	
+	TArray<FResult> Results;
+	const FString LibraryDirectory = FPaths::ProjectSavedDir() / TEXT("Benchmarks/TileLibrary/");
+	IFileManager::Get().DeleteDirectory(*LibraryDirectory, false, true);
+	
+	UE_LOG(LogTemp, Display, TEXT("Benchmark: generating %d %s tiles of %dx%d"), Settings.TileCount, *Settings.Format, Settings.TileSize, Settings.TileSize);
+	GenerateTileLibrary(LibraryDirectory, TEXT("Tile"), Settings.TileCount, Settings);
+	
+	// Swap the controller over to the synthetic library and walls
+	MyController->CancelLibraryMount();
+	// Deferred work is run within each measurement rather than over the following frames
+	UMyFrameScheduler* Scheduler = UMyFrameScheduler::Get(World);
+	UMyTextureUploader* TextureUploader = UMyTextureUploader::Get(World);
+	const auto FlushDeferredWork = [Scheduler, TextureUploader]() {
+		Scheduler->Flush();
+		TextureUploader->Flush();
+	};
+	FlushDeferredWork();
+	TArray<FString> PreviousLibraryRoots = MoveTemp(MyController->LibraryRoots);
+	TArray<FMyDynamicMat> PreviousDynamicMaterialArray = MoveTemp(MyController->DynamicMaterialArray);
+	TArray<AActor*> PreviousWalls = MoveTemp(MyController->MyWalls);
+	MyController->ClearSelectedWalls();
+	MyController->LibraryRoots = {AMyController::NormaliseLibraryRoot(LibraryDirectory)};
+	MyController->DynamicMaterialArray.Reset();
+	MyController->RebuildDynamicMaterialIndices();
+	MyController->RebuildTileIndices();
+	
+	// Startup import
+	const double MemoryBeforeImport = GetUsedPhysicalMegabytes(false);
+	const double ImportSeconds = MeasureSeconds([MyController, &FlushDeferredWork]() {
+		MyController->InitialiseDynamicMaterialArray();
+		FlushDeferredWork();
+	});
+	Results.Add({TEXT("ImportTotal"), ImportSeconds * 1000.0, TEXT("ms")});
+	Results.Add({TEXT("ImportPerTile"), ImportSeconds * 1000.0 / FMath::Max(Settings.TileCount, 1), TEXT("ms")});
+	Results.Add({TEXT("ImportMemoryDelta"), GetUsedPhysicalMegabytes(false) - MemoryBeforeImport, TEXT("MB")});
+	
+	// Grid population
+	if (MyHUD) {
+		Results.Add({TEXT("GridPopulation"), MeasureSeconds([MyHUD, MyController, &FlushDeferredWork]() {
+			MyHUD->RefreshTilesWidget(MyController->DynamicMaterialArray);
+			FlushDeferredWork();
+		}) * 1000.0, TEXT("ms")});
+	}
+
+	// Lookups by name, as done when rendering a save file
+	TArray<FName> TileNames;
+	for (const FMyDynamicMat& DynamicMat : MyController->DynamicMaterialArray) {
+		TileNames.Add(DynamicMat.CleanName);
+	}
+	if (!TileNames.IsEmpty()) {
+		int32 Found = 0;
+		const double LookupSeconds = MeasureSeconds([MyController, &TileNames, &Found, &Settings]() {
+			for (int32 LookupIndex = 0; LookupIndex < Settings.LookupCount; LookupIndex++) {
+				Found += MyController->FindDynamicMaterial(TileNames[LookupIndex % TileNames.Num()]) != nullptr;
+			}
+		});
+		Results.Add({TEXT("LookupByName"), LookupSeconds * 1e9 / FMath::Max(Settings.LookupCount, 1), TEXT("ns")});
+	}
+
+	// Walls, each showing one of the synthetic tiles so they can be saved. Near-duplicates are only loaded when used, so
+	// the walls show the representative of their tile's group, which is loaded on import
+	TArray<AMyActor*> Walls = SpawnWalls(World, MyController->WallsTag, Settings.WallCount);
+	for (int32 WallIndex = 0; WallIndex < Walls.Num() && !MyController->DynamicMaterialArray.IsEmpty(); WallIndex++) {
+		const FMyDynamicMat& Tile = MyController->DynamicMaterialArray[WallIndex % MyController->DynamicMaterialArray.Num()];
+		const FMyDynamicMat& DynamicMat = MyController->DynamicMaterialArray[MyController->TileIdIndices[Tile.RepresentativeId]];
+		UMaterialInstanceDynamic* DynamicMaterial = DynamicMat.DynamicMaterial;
+		Walls[WallIndex]->MaterialInterface = DynamicMaterial;
+		Walls[WallIndex]->StaticMesh->SetMaterial(M_MAT_NUM, DynamicMaterial);
+	}
+
+	// Save and load, keeping the user's save file aside
+	USaveGame* PreviousSaveGame = UGameplayStatics::DoesSaveGameExist(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM)
+		? UGameplayStatics::LoadGameFromSlot(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM) : nullptr;
+	Results.Add({TEXT("SaveGame"), MeasureSeconds([MyController]() {
+		MyController->SaveGame();
+	}) * 1000.0, TEXT("ms")});
+	Results.Add({TEXT("LoadGame"), MeasureSeconds([MyController, &FlushDeferredWork]() {
+		MyController->LoadGame();
+		FlushDeferredWork();
+	}) * 1000.0, TEXT("ms")});
+	if (PreviousSaveGame) {
+		UGameplayStatics::SaveGameToSlot(PreviousSaveGame, M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM);
+	} else {
+		UGameplayStatics::DeleteGameInSlot(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM);
+	}
+
+	// Watcher storm: a burst of additions, then modifications, then removals, as reported by the directory watcher
+	GenerateTileLibrary(LibraryDirectory, TEXT("Storm"), Settings.StormSize, Settings);
+	TArray<FFileChangeData> StormEvents;
+	for (int32 StormIndex = 0; StormIndex < Settings.StormSize; StormIndex++) {
+		const FString StormFile = FPaths::ConvertRelativePathToFull(FString::Printf(TEXT("%sStorm_%05d.%s"), *LibraryDirectory, StormIndex, *Settings.Format));
+		StormEvents.Add(FFileChangeData(StormFile, FFileChangeData::FCA_Added));
+	}
+	Results.Add({TEXT("WatcherStormAdded"), MeasureSeconds([MyController, &FlushDeferredWork, &StormEvents]() {
+		MyController->OnProjectDirectoryChanged(StormEvents);
+		FlushDeferredWork();
+	}) * 1000.0, TEXT("ms")});
+	
+	for (FFileChangeData& StormEvent : StormEvents) {
+		StormEvent.Action = FFileChangeData::FCA_Modified;
+	}
+	Results.Add({TEXT("WatcherStormModified"), MeasureSeconds([MyController, &FlushDeferredWork, &StormEvents]() {
+		MyController->OnProjectDirectoryChanged(StormEvents);
+		FlushDeferredWork();
+	}) * 1000.0, TEXT("ms")});
+	
+	for (FFileChangeData& StormEvent : StormEvents) {
+		IFileManager::Get().Delete(*StormEvent.Filename);
+		StormEvent.Action = FFileChangeData::FCA_Removed;
+	}
+	Results.Add({TEXT("WatcherStormRemoved"), MeasureSeconds([MyController, &FlushDeferredWork, &StormEvents]() {
+		MyController->OnProjectDirectoryChanged(StormEvents);
+		FlushDeferredWork();
+	}) * 1000.0, TEXT("ms")});
+	
+	Results.Add({TEXT("PeakUsedPhysical"), GetUsedPhysicalMegabytes(true), TEXT("MB")});
+
+	// Restore the controller, the walls and the tile widget
+	for (AMyActor* Wall : Walls) {
+		Wall->Destroy();
+	}
+	const TSet<const UMaterialInterface*> WallMaterials = MyController->GetWallMaterials();
+	for (const FMyDynamicMat& DynamicMat : MyController->DynamicMaterialArray) {
+		FMyStats::TileRemoved(DynamicMat);
+		MyController->ReleaseTileMaterial(DynamicMat, WallMaterials);
+	}
+	MyController->LibraryRoots = MoveTemp(PreviousLibraryRoots);
+	MyController->DynamicMaterialArray = MoveTemp(PreviousDynamicMaterialArray);
+	MyController->RebuildDynamicMaterialIndices();
+	MyController->RebuildTileIndices();
+	MyController->MyWalls = MoveTemp(PreviousWalls);
+	if (MyHUD) {
+		MyHUD->RefreshTilesWidget(MyController->DynamicMaterialArray);
+	}
+	IFileManager::Get().DeleteDirectory(*LibraryDirectory, false, true);
+
+	WriteReport(Settings, Results);
+}
+
+/**
+ * Writes Count synthetic tiles to Directory. Every tile is a deterministic pattern of its own colour, so the encoded
+ * size and decode cost are stable from one run to the next
+ * @param Directory Destination directory
+ * @param Prefix Prefix of the generated file names
+ * @param Count Number of tiles to generate
+ * @param Settings Size and format of the tiles
+ */
+void FMyBenchmark::GenerateTileLibrary(const FString& Directory, const FString& Prefix, const int32 Count, const FSettings& Settings) {
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	const bool bJpeg = Settings.Format == TEXT("jpg") || Settings.Format == TEXT("jpeg");
+	const int32 Size = FMath::Max(Settings.TileSize, 1);
+	
+	TArray<FColor> Pixels;
+	Pixels.SetNumUninitialized(Size * Size);
+	for (int32 TileIndex = 0; TileIndex < Count; TileIndex++) {
+		const FColor BaseColor = FLinearColor::MakeFromHSV8(static_cast<uint8>(TileIndex * 37), 96, 224).ToFColor(true);
+		for (int32 Y = 0; Y < Size; Y++) {
+			for (int32 X = 0; X < Size; X++) {
+				// Grout lines every eighth of the tile plus a slight gradient
+				const bool bGrout = (X % FMath::Max(Size / 8, 1)) < 2 || (Y % FMath::Max(Size / 8, 1)) < 2;
+				const uint8 Shade = static_cast<uint8>(255 - (X + Y) * 48 / (2 * Size));
+				Pixels[Y * Size + X] = bGrout ? FColor(200, 200, 200, 255) : FColor(BaseColor.R * Shade / 255, BaseColor.G * Shade / 255, BaseColor.B * Shade / 255, 255);
+			}
+		}
+		
+		const TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(bJpeg ? EImageFormat::JPEG : EImageFormat::PNG);
+		if (ImageWrapper.IsValid() && ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Size, Size, ERGBFormat::BGRA, 8)) {
+			const FString Filename = FString::Printf(TEXT("%s%s_%05d.%s"), *Directory, *Prefix, TileIndex, *Settings.Format);
+			FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(bJpeg ? 90 : 0), *Filename);
+		}
+	}
+}
+
+/**
+ * Spawns tagged walls the same way they are set up in the levels: the walls tag first, then the wall name
+ * @param World World to spawn the walls in
+ * @param WallsTag Tag the controller uses to find the walls
+ * @param Count Number of walls to spawn
+ * @return The spawned walls
+ */
+TArray<AMyActor*> FMyBenchmark::SpawnWalls(UWorld* World, const FName WallsTag, const int32 Count) {
+	TArray<AMyActor*> Walls;
+	Walls.Reserve(Count);
+	for (int32 WallIndex = 0; WallIndex < Count; WallIndex++) {
+		const FTransform Transform(FVector(WallIndex % 100 * 200.0, WallIndex / 100 * 200.0, 0.0));
+		AMyActor* Wall = World->SpawnActorDeferred<AMyActor>(AMyActor::StaticClass(), Transform);
+		if (Wall) {
+			Wall->Tags.Add(WallsTag);
+			Wall->Tags.Add(FName(FString::Printf(TEXT("Benchmark_Wall_%05d"), WallIndex)));
+			Wall->FinishSpawning(Transform);
+			Walls.Add(Wall);
+		}
+	}
+	return Walls;
+}
+
+/**
+ * Measures how long a piece of code takes to run
+ * @param Body Code to measure
+ * @return The elapsed time in seconds
+ */
+double FMyBenchmark::MeasureSeconds(TFunctionRef<void()> Body) {
+	const double StartTime = FPlatformTime::Seconds();
+	Body();
+	return FPlatformTime::Seconds() - StartTime;
+}
+
+/**
+ * Returns the physical memory used by the process
+ * @param bPeak Whether to return the peak since the process started instead of the current value
+ * @return The used physical memory in megabytes
+ */
+double FMyBenchmark::GetUsedPhysicalMegabytes(const bool bPeak) {
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	return (bPeak ? MemoryStats.PeakUsedPhysical : MemoryStats.UsedPhysical) / (1024.0 * 1024.0);
+}
+
+/**
+ * Logs the results and writes them to Saved/Benchmarks/Benchmark_<date>.csv and .json, along with the settings and
+ * the build they were measured on so reports from different builds can be compared
+ * @param Settings Settings the benchmark ran with
+ * @param Results Measurements
+ */
+void FMyBenchmark::WriteReport(const FSettings& Settings, const TArray<FResult>& Results) {
+	const FString BaseFilename = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("Benchmark_%s"), *FDateTime::Now().ToString());
+	const FString BuildVersion = FEngineVersion::Current().ToString();
+	const FString BuildConfiguration = LexToString(FApp::GetBuildConfiguration());
+	
+	FString Csv = TEXT("Metric,Value,Unit\n");
+	const TSharedRef<FJsonObject> JsonReport = MakeShared<FJsonObject>();
+	const TSharedRef<FJsonObject> JsonSettings = MakeShared<FJsonObject>();
+	const TSharedRef<FJsonObject> JsonResults = MakeShared<FJsonObject>();
+	
+	JsonReport->SetStringField(TEXT("EngineVersion"), BuildVersion);
+	JsonReport->SetStringField(TEXT("BuildConfiguration"), BuildConfiguration);
+	JsonReport->SetStringField(TEXT("Date"), FDateTime::Now().ToIso8601());
+	JsonSettings->SetNumberField(TEXT("Tiles"), Settings.TileCount);
+	JsonSettings->SetNumberField(TEXT("Size"), Settings.TileSize);
+	JsonSettings->SetStringField(TEXT("Format"), Settings.Format);
+	JsonSettings->SetNumberField(TEXT("Walls"), Settings.WallCount);
+	JsonSettings->SetNumberField(TEXT("Storm"), Settings.StormSize);
+	JsonSettings->SetNumberField(TEXT("Lookups"), Settings.LookupCount);
+	JsonReport->SetObjectField(TEXT("Settings"), JsonSettings);
+	
+	UE_LOG(LogTemp, Display, TEXT("Benchmark results (%s, %s):"), *BuildVersion, *BuildConfiguration);
+	for (const FResult& Result : Results) {
+		UE_LOG(LogTemp, Display, TEXT("  %-24s %12.3f %s"), *Result.Name, Result.Value, *Result.Unit);
+		Csv += FString::Printf(TEXT("%s,%f,%s\n"), *Result.Name, Result.Value, *Result.Unit);
+		
+		const TSharedRef<FJsonObject> JsonResult = MakeShared<FJsonObject>();
+		JsonResult->SetNumberField(TEXT("Value"), Result.Value);
+		JsonResult->SetStringField(TEXT("Unit"), Result.Unit);
+		JsonResults->SetObjectField(Result.Name, JsonResult);
+	}
+	JsonReport->SetObjectField(TEXT("Results"), JsonResults);
+	
+	FString Json;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(JsonReport, JsonWriter);
+	
+	FFileHelper::SaveStringToFile(Csv, *(BaseFilename + TEXT(".csv")));
+	FFileHelper::SaveStringToFile(Json, *(BaseFilename + TEXT(".json")));
+	UE_LOG(LogTemp, Display, TEXT("Benchmark report written to %s.csv/.json"), *BaseFilename);
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AMyActor;
+class AMyController;
+
+/**
+ * Repeatable performance benchmark of the tile pipeline. It generates a synthetic tile library and a synthetic set of
+ * tagged walls, drives the controller and HUD through them and writes the measurements to a CSV and a JSON report.
+ * Runs in a game world, so it works headless:
+ *   MDVProject4 -nullrhi -unattended -ExecCmds="MDV.Benchmark.Run Tiles=500 Size=1024 Format=jpg Walls=2000, Quit"
+ */
+class MDVPROJECT4_API FMyBenchmark {
+public:
+	static void Run(const TArray<FString>& Args, UWorld* World);
+
+private:
+	struct FSettings {
+		int32 TileCount = 200;
+		int32 TileSize = 512;
+		FString Format = TEXT("png");
+		int32 WallCount = 400;
+		int32 StormSize = 100;
+		int32 LookupCount = 100000;
+	};
+
+	struct FResult {
+		FString Name;
+		double Value;
+		FString Unit;
+	};
+
+	static void GenerateTileLibrary(const FString& Directory, const FString& Prefix, int32 Count, const FSettings& Settings);
+
+	static TArray<AMyActor*> SpawnWalls(UWorld* World, FName WallsTag, int32 Count);
+
+	static double MeasureSeconds(TFunctionRef<void()> Body);
+
+	static double GetUsedPhysicalMegabytes(bool bPeak);
+
+	static void WriteReport(const FSettings& Settings, const TArray<FResult>& Results);
+};
@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyInputRecorder.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "MDVProject4/Controller/AMyController.h"
+#include "MDVProject4/Controller/MyReferenceManager.h"
+#include "MDVProject4/Controller/MyWorldRegistry.h"
+#include "MDVProject4/Objects/AMyActor.h"
+#include "MDVProject4/UI/HUD/MyHUD.h"
+#include "MDVProject4/Utils/Defines.h"
+#include "MDVProject4/Utils/MyStats.h"
+
+// "MDVR", followed by the format version
+static constexpr uint32 SessionMagic = 0x5256444D;
+static constexpr uint32 SessionVersion = 1;
+
+static FAutoConsoleCommand StartRecordingCommand(
+	TEXT("MDV.Record.Start"),
+	TEXT("Starts recording the user session"),
+	FConsoleCommandDelegate::CreateStatic(&FMyInputRecorder::StartRecording));
+
+static FAutoConsoleCommand StopRecordingCommand(
+	TEXT("MDV.Record.Stop"),
+	TEXT("Stops recording and writes the session to Saved/Recordings. Usage: MDV.Record.Stop [Name]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		FMyInputRecorder::StopRecording(Args.IsValidIndex(0) ? Args[0] : FString::Printf(TEXT("Session_%s"), *FDateTime::Now().ToString()));
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs StartReplayCommand(
+	TEXT("MDV.Replay.Start"),
+	TEXT("Replays a recorded session and reports its frame timings. Usage: MDV.Replay.Start <File>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		if (Args.IsValidIndex(0)) {
+			FMyInputRecorder::StartReplay(World, Args[0]);
+		}
+	}));
+
+
+/**
+ * Appends an event to the session being recorded, does nothing when not recording
+ * @param Type Kind of event
+ * @param Name Wall tag name, tile name or file path the event refers to
+ * @param bFlag Additive selection for wall and box selections
+ * @param Start Mouse position, or box start for box selections
+ * @param End Box end for box selections
+ */
+void FMyInputRecorder::Record(const EMyRecordedEventType Type, const FString& Name, const bool bFlag, const FVector2D& Start, const FVector2D& End) {
+	if (!bRecording) {
+		return;
+	}
+	
+	// Names are stored once in a table and referenced by index
+	int32 NameIndex = INDEX_NONE;
+	if (!Name.IsEmpty()) {
+		if (const int32* ExistingIndex = RecordedNameIndices.Find(Name)) {
+			NameIndex = *ExistingIndex;
+		} else {
+			NameIndex = RecordedNames.Add(Name);
+			RecordedNameIndices.Add(Name, NameIndex);
+		}
+	}
+	
+	RecordedEvents.Add({
+		static_cast<uint32>(GFrameCounter - RecordingStartFrame),
+		static_cast<float>(FPlatformTime::Seconds() - RecordingStartTime),
+		static_cast<uint8>(Type),
+		static_cast<uint8>(bFlag),
+		NameIndex,
+		FVector2f(Start),
+		FVector2f(End)});
+}
+
+/**
+ * Starts recording a new session, discarding any session that was not written
+ */
+void FMyInputRecorder::StartRecording() {
+	RecordedEvents.Reset();
+	RecordedNames.Reset();
+	RecordedNameIndices.Reset();
+	RecordingStartFrame = GFrameCounter;
+	RecordingStartTime = FPlatformTime::Seconds();
+	bRecording = true;
+	UE_LOG(LogTemp, Display, TEXT("Session recording started"));
+}
+
+/**
+ * Stops recording and writes the session to Saved/Recordings/<SessionName>.mdvrec
+ * @param SessionName Name of the session file
+ */
+void FMyInputRecorder::StopRecording(const FString& SessionName) {
+	if (!bRecording) {
+		return;
+	}
+	bRecording = false;
+	
+	TArray<uint8> Buffer;
+	FMemoryWriter Writer(Buffer);
+	SerializeSession(Writer, RecordedNames, RecordedEvents);
+	
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("Recordings") / SessionName + TEXT(".mdvrec");
+	if (FFileHelper::SaveArrayToFile(Buffer, *Filename)) {
+		UE_LOG(LogTemp, Display, TEXT("Session recording written to %s (%d events, %d bytes)"), *Filename, RecordedEvents.Num(), Buffer.Num());
+	} else {
+		UE_LOG(LogTemp, Error, TEXT("Could not write session recording to %s"), *Filename);
+	}
+}
+
+/**
+ * Reads or writes a session
+ * @param Archive Archive to serialize with
+ * @param Names Name table
+ * @param Events Recorded events
+ * @return False if the archive does not hold a session of this version
+ */
+bool FMyInputRecorder::SerializeSession(FArchive& Archive, TArray<FString>& Names, TArray<FMyRecordedEvent>& Events) {
+	uint32 Magic = SessionMagic;
+	uint32 Version = SessionVersion;
+	Archive << Magic << Version;
+	if (Magic != SessionMagic || Version != SessionVersion) {
+		return false;
+	}
+	Archive << Names << Events;
+	return !Archive.IsError();
+}
+
+/**
+ * Loads a recorded session and starts replaying it on the following frames. The user's save slot is kept aside
+ * because the session may save, load or delete
+ * @param World World with the level the session was recorded in
+ * @param Filename Session file
+ */
+void FMyInputRecorder::StartReplay(UWorld* World, const FString& Filename) {
+	if (ReplayTickerHandle.IsValid()) {
+		UE_LOG(LogTemp, Warning, TEXT("A session is already being replayed"));
+		return;
+	}
+	
+	TArray<uint8> Buffer;
+	if (!FFileHelper::LoadFileToArray(Buffer, *Filename)) {
+		UE_LOG(LogTemp, Error, TEXT("Could not read session recording %s"), *Filename);
+		return;
+	}
+	FMemoryReader Reader(Buffer);
+	ReplayNames.Reset();
+	ReplayEvents.Reset();
+	if (!SerializeSession(Reader, ReplayNames, ReplayEvents)) {
+		UE_LOG(LogTemp, Error, TEXT("%s is not a session recording of version %d"), *Filename, SessionVersion);
+		return;
+	}
+
+	AMyController* MyController = UMyWorldRegistry::Get(World)->GetController();
+	if (!MyController || !AMyController::MyReferenceManager) {
+		UE_LOG(LogTemp, Error, TEXT("MDV.Replay.Start needs a level with an AMyController and an AMyReferenceManager"));
+		return;
+	}
+	
+	ReplayController = MyController;
+
+	ReplaySaveGameBackup.Reset(UGameplayStatics::DoesSaveGameExist(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM)
+		? UGameplayStatics::LoadGameFromSlot(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM) : nullptr);
+	
+	ReplayFilename = Filename;
+	ReplayCursor = 0;
+	ReplayFrame = 0;
+	ReplayFrameTimes.Reset();
+	ReplayDispatchTimes.Reset();
+	ReplayTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&FMyInputRecorder::TickReplay));
+	UE_LOG(LogTemp, Display, TEXT("Replaying %s (%d events)"), *Filename, ReplayEvents.Num());
+}
+
+/**
+ * Dispatches the events recorded for the current replay frame and collects the frame timings
+ * @param DeltaTime Duration of the previous frame
+ * @return False once the replay is over, which removes the ticker
+ */
+bool FMyInputRecorder::TickReplay(const float DeltaTime) {
+	if (!ReplayController.IsValid()) {
+		UE_LOG(LogTemp, Warning, TEXT("Replay aborted, the world has been torn down"));
+		FinishReplay();
+		return false;
+	}
+	
+	if (ReplayFrame > 0) {
+		ReplayFrameTimes.Add(DeltaTime * 1000.0);
+	}
+	
+	const double DispatchStartTime = FPlatformTime::Seconds();
+	while (ReplayCursor < ReplayEvents.Num() && ReplayEvents[ReplayCursor].Frame <= ReplayFrame) {
+		DispatchEvent(ReplayEvents[ReplayCursor++]);
+	}
+	ReplayDispatchTimes.Add((FPlatformTime::Seconds() - DispatchStartTime) * 1000.0);
+	ReplayFrame++;
+
+	if (ReplayCursor >= ReplayEvents.Num()) {
+		FinishReplay();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Re-drives the controller and HUD call that the recorded event originally triggered
+ * @param Event Recorded event
+ */
+void FMyInputRecorder::DispatchEvent(const FMyRecordedEvent& Event) {
+	AMyController* MyController = ReplayController.Get();
+	AMyHUD* MyHUD = AMyController::MyReferenceManager->MyHUD;
+	const FString Name = ReplayNames.IsValidIndex(Event.NameIndex) ? ReplayNames[Event.NameIndex] : FString();
+	AMyActor* MyWall = UMyWorldRegistry::Get(MyController)->FindWall(FName(*Name));
+
+	switch (static_cast<EMyRecordedEventType>(Event.Type)) {
+		case EMyRecordedEventType::ScreenClicked:
+			MyController->ScreenClicked(Event.bFlag != 0);
+			break;
+		
+		case EMyRecordedEventType::BoxSelect:
+			MyController->SelectWallsInScreenBox(FVector2D(Event.Start), FVector2D(Event.End), Event.bFlag != 0);
+			break;
+		
+		case EMyRecordedEventType::WallHovered:
+			if (MyWall) {
+				MyWall->WallHovered();
+			}
+			break;
+		
+		case EMyRecordedEventType::WallUnHovered:
+			if (MyWall) {
+				MyWall->WallUnHovered();
+			}
+			break;
+		
+		case EMyRecordedEventType::WallSelected:
+			MyController->UpdateSelectedWall(MyWall, Event.bFlag != 0);
+			break;
+		
+		case EMyRecordedEventType::TileClicked:
+			MyController->LoadDynamicMaterial(FName(*Name), [WeakHUD = TWeakObjectPtr<AMyHUD>(MyHUD)](const FMyDynamicMat* DynamicMat) {
+				if (DynamicMat && WeakHUD.IsValid()) {
+					WeakHUD->UpdateWallMaterial(DynamicMat->DynamicMaterial);
+				}
+			});
+			break;
+		
+		case EMyRecordedEventType::DefaultPressed:
+			MyHUD->UpdateWallMaterial(nullptr);
+			break;
+		
+		case EMyRecordedEventType::SavePressed:
+			MyHUD->SaveGameButtonPressed();
+			break;
+		
+		case EMyRecordedEventType::LoadPressed:
+			MyHUD->LoadGameButtonPressed();
+			break;
+		
+		case EMyRecordedEventType::DeletePressed:
+			MyHUD->DeleteButtonPressed();
+			break;
+		
+		case EMyRecordedEventType::SelectGroupPressed:
+			MyHUD->SelectGroupPressed();
+			break;
+		
+		case EMyRecordedEventType::TileTransformChanged: {
+			FMyTileTransform TileTransform;
+			FMyTileTransform::StaticStruct()->ImportText(*Name, &TileTransform, nullptr, PPF_None, GLog, FMyTileTransform::StaticStruct()->GetName());
+			MyHUD->TileTransformChanged(TileTransform);
+		}
+		break;
+		
+		case EMyRecordedEventType::FileAdded:
+		case EMyRecordedEventType::FileModified:
+		case EMyRecordedEventType::FileRemoved: {
+			const FFileChangeData::EFileChangeAction Action = Event.Type == static_cast<uint8>(EMyRecordedEventType::FileAdded) ? FFileChangeData::FCA_Added
+				: Event.Type == static_cast<uint8>(EMyRecordedEventType::FileModified) ? FFileChangeData::FCA_Modified : FFileChangeData::FCA_Removed;
+			// The library on this machine may differ from the recorded one, files that cannot be imported are skipped
+			if (Action != FFileChangeData::FCA_Removed && !FPaths::FileExists(Name)) {
+				UE_LOG(LogTemp, Warning, TEXT("Replay skipped a change to %s, the file does not exist"), *Name);
+				break;
+			}
+			MyController->OnProjectDirectoryChanged({FFileChangeData(Name, Action)});
+		}
+		break;
+		
+		default: ;
+	}
+}
+
+/**
+ * Ends the replay, restores the user's save slot and reports the timings to the log and to Saved/Benchmarks
+ */
+void FMyInputRecorder::FinishReplay() {
+	ReplayTickerHandle.Reset();
+	
+	if (ReplaySaveGameBackup.IsValid()) {
+		UGameplayStatics::SaveGameToSlot(ReplaySaveGameBackup.Get(), M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM);
+	} else {
+		UGameplayStatics::DeleteGameInSlot(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM);
+	}
+	ReplaySaveGameBackup.Reset();
+	
+	UE_LOG(LogTemp, Display, TEXT("Replay of %s finished: %d/%d events over %u frames"), *ReplayFilename, ReplayCursor, ReplayEvents.Num(), ReplayFrame);
+	FString Csv = FMyStats::TimingsCsvHeader;
+	FMyStats::ReportTimings(TEXT("FrameTime"), ReplayFrameTimes, Csv);
+	FMyStats::ReportTimings(TEXT("DispatchTime"), ReplayDispatchTimes, Csv);
+	
+	const FString ReportFilename = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("Replay_%s_%s.csv"), *FPaths::GetBaseFilename(ReplayFilename), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(Csv, *ReportFilename);
+	UE_LOG(LogTemp, Display, TEXT("Replay report written to %s"), *ReportFilename);
+	
+	ReplayEvents.Reset();
+	ReplayNames.Reset();
+}
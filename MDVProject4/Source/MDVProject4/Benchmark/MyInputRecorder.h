@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "GameFramework/SaveGame.h"
+#include "UObject/StrongObjectPtr.h"
+
+class AMyController;
+
+enum class EMyRecordedEventType : uint8 {
+	ScreenClicked,
+	BoxSelect,
+	WallHovered,
+	WallUnHovered,
+	WallSelected,
+	TileClicked,
+	DefaultPressed,
+	SavePressed,
+	LoadPressed,
+	DeletePressed,
+	SelectGroupPressed,
+	TileTransformChanged,
+	FileAdded,
+	FileModified,
+	FileRemoved,
+};
+
+/**
+ * Records user sessions (clicks, wall hovers and selections, tile picker buttons and library changes) into a compact
+ * event log, and replays them by re-driving the same controller and HUD calls, frame for frame, while collecting frame
+ * timings. A recorded session thus becomes a regression benchmark:
+ *   MDV.Record.Start / MDV.Record.Stop [Name]
+ *   MDVProject4 -nullrhi -ExecCmds="MDV.Replay.Start Saved/Recordings/Session.mdvrec"
+ */
+class MDVPROJECT4_API FMyInputRecorder {
+public:
+	static void Record(EMyRecordedEventType Type, const FString& Name = FString(), bool bFlag = false, const FVector2D& Start = FVector2D::ZeroVector, const FVector2D& End = FVector2D::ZeroVector);
+
+	static bool IsRecording() { return bRecording; }
+
+	static void StartRecording();
+
+	static void StopRecording(const FString& SessionName);
+
+	static void StartReplay(UWorld* World, const FString& Filename);
+
+private:
+	struct FMyRecordedEvent {
+		uint32 Frame;
+		float Time;
+		uint8 Type;
+		uint8 bFlag;
+		int32 NameIndex;
+		FVector2f Start;
+		FVector2f End;
+
+		friend FArchive& operator<<(FArchive& Archive, FMyRecordedEvent& Event) {
+			return Archive << Event.Frame << Event.Time << Event.Type << Event.bFlag << Event.NameIndex << Event.Start << Event.End;
+		}
+	};
+
+	static bool SerializeSession(FArchive& Archive, TArray<FString>& Names, TArray<FMyRecordedEvent>& Events);
+
+	static bool TickReplay(float DeltaTime);
+
+	static void DispatchEvent(const FMyRecordedEvent& Event);
+
+	static void FinishReplay();
+
+	static inline bool bRecording = false;
+	static inline uint64 RecordingStartFrame = 0;
+	static inline double RecordingStartTime = 0.0;
+	static inline TArray<FMyRecordedEvent> RecordedEvents;
+	static inline TArray<FString> RecordedNames;
+	static inline TMap<FString, int32> RecordedNameIndices;
+
+	static inline TWeakObjectPtr<AMyController> ReplayController;
+	static inline TArray<FMyRecordedEvent> ReplayEvents;
+	static inline TArray<FString> ReplayNames;
+	static inline int32 ReplayCursor = 0;
+	static inline uint32 ReplayFrame = 0;
+	static inline FString ReplayFilename;
+	static inline TArray<double> ReplayFrameTimes;
+	static inline TArray<double> ReplayDispatchTimes;
+	static inline FTSTicker::FDelegateHandle ReplayTickerHandle;
+	static inline TStrongObjectPtr<USaveGame> ReplaySaveGameBackup;
+};
@@ -5,18 +5,46 @@
 
 
 #include "IDirectoryWatcher.h"
+#include "Algo/MaxElement.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "DirectoryWatcherModule.h"
 #include "ImageUtils.h"
+#include "Hash/xxhash.h"
+#include "HAL/IConsoleManager.h"
 #include "MyReferenceManager.h"
 #include "MySaveGame.h"
+#include "MyScreenshotService.h"
+#include "MyWorldRegistry.h"
 #include "Engine/Texture.h"
 #include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetRenderingLibrary.h"
+#include "MyFrameScheduler.h"
+#include "MyTextureUploader.h"
+#include "MyTilePool.h"
 #include "MDVProject4/Objects/AMyActor.h"
+#include "MDVProject4/Benchmark/MyInputRecorder.h"
+#include "MDVProject4/Pack/MyTilePack.h"
 #include "EditorFramework/AssetImportData.h"
 #include "MDVProject4/UI/HUD/MyHUD.h"
 #include "MDVProject4/UI/Widgets/TileSelect.h"
 #include "MDVProject4/Utils/Defines.h"
+#include "MDVProject4/Utils/ImageKernels.h"
+#include "MDVProject4/Utils/MyLatencyTracker.h"
+#include "MDVProject4/Utils/MyStats.h"
+
+static FAutoConsoleCommandWithWorldAndArgs MountLibraryCommand(
+	TEXT("MDV.Library.Mount"),
+	TEXT("Replaces the tile library by the tiles of one or more directories, indexed in the background. ")
+	TEXT("Usage: MDV.Library.Mount <Directory> [Directory...]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		const UMyWorldRegistry* Registry = UMyWorldRegistry::Get(World);
+		AMyController* MyController = Registry ? Registry->GetController() : nullptr;
+		if (!MyController || Args.IsEmpty()) {
+			UE_LOG(LogTemp, Error, TEXT("MDV.Library.Mount needs a level with an AMyController and at least one directory"));
+			return;
+		}
+		MyController->MountLibraryRoots(Args);
+	}));
 
 
 AMyController::AMyController() {
@@ -24,104 +52,237 @@ AMyController::AMyController() {
 	BaseMaterial = LoadObject<UMaterialInterface>(nullptr, TEXT("/Script/Engine.Material'/Game/Resources/BaseMaterial.BaseMaterial'"));
 	MessageDataTable = LoadObject<UDataTable>(nullptr, TEXT("/Script/Engine.DataTable'/Game/DataTable/DT_UIMessages.DT_UIMessages'"));
 		
-	ResourcesDirPath = FPaths::ProjectContentDir() + M_DIR_CONTENT_PATH;
+	LibraryRoots.Add(NormaliseLibraryRoot(FPaths::ProjectContentDir() + M_DIR_CONTENT_PATH));
 	WallHovered = false;
 }
 
 
 void AMyController::BeginPlay() {
 	Super::BeginPlay();
-	MyReferenceManager = Cast<AMyReferenceManager>(UGameplayStatics::GetActorOfClass(GetWorld(), AMyReferenceManager::StaticClass()));
-	UGameplayStatics::GetAllActorsOfClassWithTag(GetWorld(), AMyActor::StaticClass(), WallsTag, MyWalls);
-	MessageDataTableRowNames = MessageDataTable->GetRowNames();
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		MyReferenceManager = Registry->GetReferenceManager();
+		for (AMyActor* MyWall : Registry->GetWalls()) {
+			WallRegistered(MyWall);
+		}
+		Registry->OnWallAdded.AddUObject(this, &AMyController::WallRegistered);
+		Registry->OnWallRemoved.AddUObject(this, &AMyController::WallUnregistered);
+	}
+	if (UMyTextureUploader* TextureUploader = UMyTextureUploader::Get(this)) {
+		TextureUploader->OnGatherVisibleMaterials.AddUObject(this, &AMyController::GatherVisibleMaterials);
+	}
+	MessageCatalog.Initialise(MessageDataTable);
 	
-	InitialiseDynamicMaterialArray();
-	CreateDirectoryWatcherDelegate();
+	// The library is created within the frame budget rather than before the first frame, and watched once created
+	MountLibraryRoots(LibraryRoots);
+
+	ScreenshotService = NewObject<UMyScreenshotService>(this);
+	ScreenshotService->Initialise();
+	ScreenshotService->OnScreenshotPreviewReady.AddUObject(this, &AMyController::ScreenshotPreviewReady);
+	ScreenshotService->OnScreenshotSaved.AddUObject(this, &AMyController::ScreenshotSaved);
+}
+
+void AMyController::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Register(this);
+	}
+}
+
+void AMyController::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	CancelLibraryMount();
+	UnregisterDirectoryWatchers();
+	if (ScreenshotService) {
+		ScreenshotService->Shutdown();
+	}
+	MessageCatalog.Shutdown();
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->OnWallAdded.RemoveAll(this);
+		Registry->OnWallRemoved.RemoveAll(this);
+		Registry->Unregister(this);
+	}
+	if (UMyTextureUploader* TextureUploader = UMyTextureUploader::Get(this)) {
+		TextureUploader->OnGatherVisibleMaterials.RemoveAll(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
- * Creates a delegate that will trigger OnProjectDirectoryChanged() when a change is performed on ResourcesDirPath
+ * Adds a wall that has been spawned or streamed in to the walls the controller manages, if it carries WallsTag
+ * @param MyWall Wall registered with the world registry
  */
-void AMyController::CreateDirectoryWatcherDelegate() {
-	static FDirectoryWatcherModule &DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
-	
-	static FDelegateHandle WatcherHandle = FDelegateHandle();
+void AMyController::WallRegistered(AMyActor* MyWall) {
+	if (MyWall->ActorHasTag(WallsTag)) {
+		MyWalls.AddUnique(MyWall);
+		ApplyTileTransform(MyWall, GetTileTransform(MyWall));
+	}
+}
+
+/**
+ * Adds the materials of the walls rendered lately, whose tiles are uploaded first
+ * @param VisibleMaterials Materials on screen, gathered by the texture uploader
+ */
+void AMyController::GatherVisibleMaterials(TSet<const UMaterialInterface*>& VisibleMaterials) const {
+	for (AActor* WallActor : MyWalls) {
+		if (WallActor->WasRecentlyRendered()) {
+			VisibleMaterials.Add(Cast<AMyActor>(WallActor)->StaticMesh->GetMaterial(M_MAT_NUM));
+		}
+	}
+}
+
+/**
+ * Forgets a wall that is being destroyed or streamed out. The tile transform of a wall streamed out is kept, and applied
+ * again by WallRegistered() once the wall streams back in
+ * @param MyWall Wall unregistered from the world registry
+ */
+void AMyController::WallUnregistered(AMyActor* MyWall) {
+	MyWalls.RemoveSingleSwap(MyWall, false);
+	if (MyWall->IsActorBeingDestroyed()) {
+		WallTileTransforms.Remove(TSoftObjectPtr<AMyActor>(MyWall));
+	}
+	if (SelectedWalls.Remove(MyWall) > 0 && MyReferenceManager && MyReferenceManager->MyHUD) {
+		MyReferenceManager->MyHUD->UpdateSelectedWallText(SelectedWalls.Array());
+	}
+}
 
-	DirectoryWatcherModule.Get()->RegisterDirectoryChangedCallback_Handle(
-		ResourcesDirPath,
-		IDirectoryWatcher::FDirectoryChanged::CreateUObject(this, &AMyController::OnProjectDirectoryChanged),
-		WatcherHandle,
-		IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges);
+/**
+ * Makes the directory watcher trigger OnProjectDirectoryChanged() when a change is performed on the LibraryRoots, and
+ * stop for the directories that are no longer library roots
+ */
+void AMyController::RegisterDirectoryWatchers() {
+	IDirectoryWatcher* DirectoryWatcher = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")).Get();
+	for (auto It = WatcherHandles.CreateIterator(); It; ++It) {
+		if (!LibraryRoots.Contains(It->Key)) {
+			DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(It->Key, It->Value);
+			It.RemoveCurrent();
+		}
+	}
+	for (const FString& Root : LibraryRoots) {
+		if (!WatcherHandles.Contains(Root)) {
+			DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(
+				Root,
+				IDirectoryWatcher::FDirectoryChanged::CreateUObject(this, &AMyController::OnProjectDirectoryChanged),
+				WatcherHandles.Add(Root),
+				IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges);
+		}
+	}
 }
 
 /**
- * Will trigger when a change (addition, replacement, deletion) is performed on ResourcesDirPath
+ * Stops watching all the library roots
+ */
+void AMyController::UnregisterDirectoryWatchers() {
+	if (FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"))) {
+		for (const TPair<FString, FDelegateHandle>& WatcherHandle : WatcherHandles) {
+			DirectoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(WatcherHandle.Key, WatcherHandle.Value);
+		}
+	}
+	WatcherHandles.Reset();
+}
+
+/**
+ * Returns the form library roots are stored in, which file paths are compared with
+ * @param Root Directory, relative or full, with or without trailing slash
+ * @return The full path of the directory, ending with a slash
+ */
+FString AMyController::NormaliseLibraryRoot(const FString& Root) {
+	return FPaths::ConvertRelativePathToFull(Root) / TEXT("");
+}
+
+/**
+ * Will trigger when a change (addition, replacement, deletion) is performed on the LibraryRoots
  * @param Data Array of type FFileChangeData indicating the nature of the change observed
  */
 void AMyController::OnProjectDirectoryChanged(const TArray<FFileChangeData>& Data) {
+	UMyFrameScheduler* Scheduler = UMyFrameScheduler::Get(this);
 	for (FFileChangeData Element : Data) {
+		EDataTableContentIndex Message;
 		switch (Element.Action) {
 			case FFileChangeData::FCA_Added:
-        		UpdateDynamicMaterialArray(UKismetSystemLibrary::ConvertToRelativePath(Element.Filename), FFileChangeData::FCA_Added);
+				FMyInputRecorder::Record(EMyRecordedEventType::FileAdded, Element.Filename);
 				//MyReferenceManager->MyHUD->AddTile();
-				MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FilesAdded));
+				Message = FilesAdded;
 				break;
 			
         	case FFileChangeData::FCA_Modified:
-        		UpdateDynamicMaterialArray(UKismetSystemLibrary::ConvertToRelativePath(Element.Filename), FFileChangeData::FCA_Modified);
+				FMyInputRecorder::Record(EMyRecordedEventType::FileModified, Element.Filename);
 				//MyReferenceManager->MyHUD->RefreshTile();
-				MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FilesModified));
+				Message = FilesModified;
         		break;
 			
         	case FFileChangeData::FCA_Removed:
-        		UpdateDynamicMaterialArray(UKismetSystemLibrary::ConvertToRelativePath(Element.Filename), FFileChangeData::FCA_Removed);
+				FMyInputRecorder::Record(EMyRecordedEventType::FileRemoved, Element.Filename);
 				//MyReferenceManager->MyHUD->RemoveTile();
-				MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FilesRemoved));
+				Message = FilesRemoved;
         		break;
 			
-	        default:;
+	        default:
+	        	continue;
 		}
+		// Each file creates or releases a tile's textures and material, so a burst of changes is spread over frames
+		Scheduler->Submit(this, EMyWorkPriority::Normal, [this, FileName = FPaths::ConvertRelativePathToFull(Element.Filename), Action = Element.Action, Message]() {
+			MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_WatcherEvents);
+			UpdateDynamicMaterialArray(FileName, Action);
+			MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(Message), M_NOTIFY_CATEGORY_LIBRARY);
+		});
 	}
-	MyReferenceManager->MyHUD->RefreshTilesWidget(DynamicMaterialArray);
+	Scheduler->Submit(this, EMyWorkPriority::Normal, [this]() {
+		MyReferenceManager->MyHUD->RefreshTilesWidget(DynamicMaterialArray);
+	});
 }
 
 /**
- * Updates the MyDynamicMatArray based on the action performed by the directory watcher delegate
+ * Updates the MyDynamicMatArray based on the action performed by the directory watcher delegate. A tile set is
+ * reloaded as a whole when any of its files changes
  * @param FileName Path to the file that requires to be handled
  * @param Action The specific action (ie. addition, replacement, deletion) that the file performed
  */
 void AMyController::UpdateDynamicMaterialArray(const FString& FileName, FFileChangeData::EFileChangeAction Action) {
-	switch (Action) {
-		case FFileChangeData::FCA_Added: {
-			InsertItemToDynamicMaterialArray(FileName);
+	// A removed map leaves its tile set, which is reloaded with its remaining files
+	if (Action == FFileChangeData::FCA_Removed) {
+		const FMyDynamicMat* SetTile = FindTileByFile(FileName);
+		if (SetTile && SetTile->Path != FileName) {
+			const FMyDynamicMat Element = *SetTile;
+			RemoveItemFromDynamicMaterialArray(Element);
+			InsertItemToDynamicMaterialArray(FMyTileSetNaming::FindSet(Element.Path));
+			return;
 		}
-		break;
-		
+	}
+	
+	switch (Action) {
+		case FFileChangeData::FCA_Added:
 		case FFileChangeData::FCA_Modified: {
-			for (FMyDynamicMat Element : DynamicMaterialArray) {
-				if (Element.Path == FileName) {
-					DynamicMaterialArray.Remove(Element);
-					InsertItemToDynamicMaterialArray(FileName);
-					break;
+			// The set may have been loaded without this file, or its files loaded as separate tiles
+			const FMyTileSetFiles TileSet = FMyTileSetNaming::FindSet(FileName);
+			for (const FString& SetFile : {TileSet.AlbedoPath, TileSet.NormalPath, TileSet.RoughnessPath}) {
+				if (const FMyDynamicMat* SetTile = SetFile.IsEmpty() ? nullptr : FindTileByFile(SetFile)) {
+					const FMyDynamicMat Element = *SetTile;
+					RemoveItemFromDynamicMaterialArray(Element);
 				}
 			}
+			InsertItemToDynamicMaterialArray(TileSet);
 		}
 		break;
 		
 		case FFileChangeData::FCA_Removed: {
 			// Search for the removed material in the DynamicMaterialArray and remove it
-			for (FMyDynamicMat Element : DynamicMaterialArray) {
-				if (Element.Path == FileName) {
-					// Search for any Wall that currently has the selected material and set it to the default one
-					for (AActor* WallActor : MyWalls) {
-						const AMyActor* MyWall = Cast<AMyActor>(WallActor);
-						if (MyWall->StaticMesh->GetMaterial(M_MAT_NUM) == Cast<UMaterialInterface>(Element.DynamicMaterial)) {
-							MyWall->StaticMesh->SetMaterial(M_MAT_NUM, MyWall->MaterialInterface);
-							MyReferenceManager->MyHUD->Notify(Warning, RetrieveDataTableMessage(PlacedTexturesDeleted));
-						}
-					}
-					DynamicMaterialArray.Remove(Element);
-					break;
+			const FMyDynamicMat* RemovedTile = FindTileByFile(FileName);
+			if (!RemovedTile) {
+				break;
+			}
+			const FMyDynamicMat Element = *RemovedTile;
+			// Search for any Wall that currently has the selected material and set it to the default one
+			for (AActor* WallActor : MyWalls) {
+				const AMyActor* MyWall = Cast<AMyActor>(WallActor);
+				if (Element.DynamicMaterial && MyWall->StaticMesh->GetMaterial(M_MAT_NUM) == Cast<UMaterialInterface>(Element.DynamicMaterial)) {
+					MyWall->StaticMesh->SetMaterial(M_MAT_NUM, MyWall->MaterialInterface);
+					MyReferenceManager->MyHUD->Notify(Warning, RetrieveDataTableMessage(PlacedTexturesDeleted));
+				}
+			}
+			RemoveItemFromDynamicMaterialArray(Element);
+			// The maps of a removed albedo are left as tiles of their own, as they would be on the next launch
+			for (const FString& MapPath : {Element.NormalPath, Element.RoughnessPath}) {
+				if (!MapPath.IsEmpty()) {
+					InsertItemToDynamicMaterialArray(FMyTileSetNaming::FindSet(MapPath));
 				}
 			}
 		}
@@ -132,209 +293,1504 @@ void AMyController::UpdateDynamicMaterialArray(const FString& FileName, FFileCha
 }
 
 /**
- * Creates and populates MyDynamicMatArray with the .png and .jpg files found in "<ProjectDir>/Resources/TileResources/"
+ * Creates and populates MyDynamicMatArray with the .png and .jpg files found in the LibraryRoots
  */
 void AMyController::InitialiseDynamicMaterialArray() {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_InitialiseCatalog);
+	FMyLibraryScan Scan = ScanLibraryRoots(LibraryRoots);
+	for (FMyDecodedTile& DecodedTile : Scan.PackedTiles) {
+		AddDecodedTile(DecodedTile, GetLiveCatalog());
+	}
+	InsertItemsToDynamicMaterialArray(Scan.LooseSets);
+}
+
+/**
+ * Lists the tiles of library roots, grouping the maps of tile sets with their albedo. Tiles packed by the MyTilePack
+ * commandlet are created from the pack, which is only mapped, unless their image file has changed or been deleted
+ * since, so a tile removed from the library does not come back from the pack on the next launch; the other
+ * tiles and the tile sets, which are not packed, have to be decoded. Safe to call from worker threads
+ * @param Roots Library roots, as returned by NormaliseLibraryRoot()
+ * @return The packed tiles, ready to be added, and the tile sets to decode
+ */
+AMyController::FMyLibraryScan AMyController::ScanLibraryRoots(const TArray<FString>& Roots) {
 	IFileManager& FileManager = IFileManager::Get();
-	TArray<FString> FoundFiles;
+	FMyLibraryScan Scan;
+	for (const FString& Root : Roots) {
+		TArray<FString> FoundFiles;
+		FileManager.FindFiles(FoundFiles, *Root, *FString("png"));
+		FileManager.FindFiles(FoundFiles, *Root, *FString("jpg"));
+		FileManager.FindFiles(FoundFiles, *Root, *FString("jpeg"));
+		const TArray<FMyTileSetFiles> TileSets = FMyTileSetNaming::Group(Root, FoundFiles);
+		TSet<FString> SetFiles;
+		for (const FMyTileSetFiles& TileSet : TileSets) {
+			if (TileSet.HasMaps()) {
+				SetFiles.Add(FPaths::GetCleanFilename(TileSet.AlbedoPath));
+				SetFiles.Add(FPaths::GetCleanFilename(TileSet.NormalPath));
+				SetFiles.Add(FPaths::GetCleanFilename(TileSet.RoughnessPath));
+			}
+		}
+
+		TSet<FString> PackedFiles;
+		const FString PackPath = FMyTilePack::GetPackPath(Root);
+		if (const TSharedPtr<FMyTilePack> TilePack = FMyTilePack::Open(PackPath)) {
+			const TSet<FString> LooseFiles(FoundFiles);
+			const TArray<FMyTilePackEntry>& Entries = TilePack->GetEntries();
+			for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); EntryIndex++) {
+				const FMyTilePackEntry& Entry = Entries[EntryIndex];
+				const FString FilePath = Root + Entry.FileName;
+				if (Entry.Mips.IsEmpty() || SetFiles.Contains(Entry.FileName)) {
+					continue;
+				}
+				if (!LooseFiles.Contains(Entry.FileName)) {
+					continue;
+				}
+				const FFileStatData StatData = FileManager.GetStatData(*FilePath);
+				if (StatData.FileSize != Entry.FileSize || StatData.ModificationTime != Entry.Timestamp) {
+					continue;
+				}
+				
+				FMyDecodedTile& DecodedTile = Scan.PackedTiles.AddDefaulted_GetRef();
+				DecodedTile.FilePath = FilePath;
+				DecodedTile.ContentHash = Entry.ContentHash;
+				DecodedTile.ColorSignature = Entry.ColorSignature;
+				DecodedTile.PerceptualHash = Entry.PerceptualHash;
+				DecodedTile.PixelCount = Entry.PixelCount;
+				DecodedTile.TilePack = TilePack;
+				DecodedTile.PackEntry = EntryIndex;
+				DecodedTile.bDecoded = true;
+				PackedFiles.Add(Entry.FileName);
+			}
+			UE_LOG(LogTemp, Display, TEXT("Found %d tiles in %s"), PackedFiles.Num(), *PackPath);
+		}
+
+		for (const FMyTileSetFiles& TileSet : TileSets) {
+			if (!PackedFiles.Contains(FPaths::GetCleanFilename(TileSet.AlbedoPath))) {
+				Scan.LooseSets.Add(TileSet);
+			}
+		}
+	}
+	return Scan;
+}
+
+/**
+ * Replaces the library by the tiles of other directories without a hitch: the directories are scanned and decoded by
+ * background tasks while the current library stays in use, their tiles are created in a staged catalog by the frame
+ * scheduler, and the staged catalog is swapped with the current one once complete. A mount in progress is cancelled
+ * @param Roots Directories to mount, relative or full
+ */
+void AMyController::MountLibraryRoots(const TArray<FString>& Roots) {
+	CancelLibraryMount();
+	
+	LibraryMountGeneration++;
+	LibraryMount = MakeUnique<FMyLibraryMount>();
+	for (const FString& Root : Roots) {
+		LibraryMount->Roots.AddUnique(NormaliseLibraryRoot(Root));
+	}
+	StagedCatalog.LibraryRoots = LibraryMount->Roots;
+	LibraryMount->ScanTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Roots = LibraryMount->Roots]() {
+		return ScanLibraryRoots(Roots);
+	});
+	LibraryMountTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &AMyController::TickLibraryMount));
+	UE_LOG(LogTemp, Display, TEXT("Mounting %s"), *FString::Join(LibraryMount->Roots, TEXT(", ")));
+}
+
+/**
+ * Returns the live catalog, for the code that fills the live and the staged catalogs alike
+ * @return References to the DynamicMaterialArray, LibraryRoots and the indices over them
+ */
+AMyController::FMyCatalogView AMyController::GetLiveCatalog() {
+	return {DynamicMaterialArray, LibraryRoots, DynamicMaterialIndices, ContentHashIndices, TileIdIndices, FileIndices,
+		TileNameIndex, DuplicateIndex, TileGroups};
+}
+
+/**
+ * Returns the staged catalog, which the tiles of the library being mounted are added to
+ * @return References to the StagedDynamicMaterialArray, the roots being mounted and the indices over them
+ */
+AMyController::FMyCatalogView AMyController::GetStagedCatalog() {
+	return {StagedDynamicMaterialArray, StagedCatalog.LibraryRoots, StagedCatalog.DynamicMaterialIndices,
+		StagedCatalog.ContentHashIndices, StagedCatalog.TileIdIndices, StagedCatalog.FileIndices, StagedCatalog.TileNameIndex,
+		StagedCatalog.DuplicateIndex, StagedCatalog.TileGroups};
+}
+
+/**
+ * Swaps the live catalog, its indices and its roots with the staged ones, once the staged catalog is complete
+ */
+void AMyController::SwapStagedCatalog() {
+	Swap(DynamicMaterialArray, StagedDynamicMaterialArray);
+	Swap(LibraryRoots, StagedCatalog.LibraryRoots);
+	Swap(DynamicMaterialIndices, StagedCatalog.DynamicMaterialIndices);
+	Swap(ContentHashIndices, StagedCatalog.ContentHashIndices);
+	Swap(TileIdIndices, StagedCatalog.TileIdIndices);
+	Swap(FileIndices, StagedCatalog.FileIndices);
+	Swap(TileNameIndex, StagedCatalog.TileNameIndex);
+	Swap(DuplicateIndex, StagedCatalog.DuplicateIndex);
+	Swap(TileGroups, StagedCatalog.TileGroups);
+}
+
+/**
+ * Advances the library mount: collects the scan, keeps one batch of files decoding ahead of the tiles scheduled for the
+ * staged catalog, and finishes the mount once every tile has been added
+ * @param DeltaTime Unused
+ * @return False once the mount is finished, which removes the ticker
+ */
+bool AMyController::TickLibraryMount(float DeltaTime) {
+	FMyLibraryMount& Mount = *LibraryMount;
+	if (!Mount.bScanned) {
+		if (!Mount.ScanTask.IsCompleted()) {
+			return true;
+		}
+		FMyLibraryScan& Scan = Mount.ScanTask.GetResult();
+		ScheduleMountedTiles(MoveTemp(Scan.PackedTiles));
+		Mount.PendingSets = MoveTemp(Scan.LooseSets);
+		Mount.bScanned = true;
+	}
+	
+	if (Mount.bDecoding && Mount.DecodeTask.IsCompleted()) {
+		ScheduleMountedTiles(MoveTemp(Mount.DecodeTask.GetResult()));
+		Mount.bDecoding = false;
+	}
+	if (!Mount.bDecoding && !Mount.PendingSets.IsEmpty() && Mount.ScheduledTiles < M_IMPORT_BATCH_SIZE) {
+		const int32 BatchSize = FMath::Min(M_IMPORT_BATCH_SIZE, Mount.PendingSets.Num());
+		Mount.DecodeTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [TileSets = TArray<FMyTileSetFiles>(Mount.PendingSets.GetData(), BatchSize)]() {
+			return DecodeTiles(TileSets);
+		});
+		Mount.PendingSets.RemoveAt(0, BatchSize, false);
+		Mount.bDecoding = true;
+	}
+	
+	if (Mount.bDecoding || !Mount.PendingSets.IsEmpty() || Mount.ScheduledTiles > 0) {
+		return true;
+	}
+	LibraryMountTickerHandle.Reset();
+	FinishLibraryMount();
+	return false;
+}
+
+/**
+ * Submits decoded tiles to the frame scheduler, each creating its texture and material in the staged catalog
+ * @param DecodedTiles Tiles of the library being mounted
+ */
+void AMyController::ScheduleMountedTiles(TArray<FMyDecodedTile>&& DecodedTiles) {
+	UMyFrameScheduler* Scheduler = UMyFrameScheduler::Get(this);
+	for (FMyDecodedTile& DecodedTile : DecodedTiles) {
+		LibraryMount->ScheduledTiles++;
+		Scheduler->Submit(this, EMyWorkPriority::Normal, [this, Generation = LibraryMountGeneration, DecodedTile = MoveTemp(DecodedTile)]() mutable {
+			if (!LibraryMount || Generation != LibraryMountGeneration) {
+				return;
+			}
+			MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_InitialiseCatalog);
+			AddDecodedTile(DecodedTile, GetStagedCatalog());
+			LibraryMount->ScheduledTiles--;
+		});
+	}
+}
+
+/**
+ * Swaps the mounted library in. Walls showing a tile of the previous library get the tile of the new one with the same
+ * file, else name, else content, and are reset to their default material when it has neither. The walls are
+ * remapped and the previous tiles released by the frame scheduler, walls first, so the switch does not hitch
+ */
+void AMyController::FinishLibraryMount() {
+	SwapStagedCatalog();
+	UMyFrameScheduler* Scheduler = UMyFrameScheduler::Get(this);
+	
+	struct FMyMountRemap {
+		int32 RemappedCount = 0;
+		bool bWallsReset = false;
+	};
+	const TSharedRef<FMyMountRemap> Remap = MakeShared<FMyMountRemap>();
+	TMap<const UMaterialInterface*, const FMyDynamicMat*> PreviousTiles;
+	for (const FMyDynamicMat& PreviousTile : StagedDynamicMaterialArray) {
+		if (PreviousTile.DynamicMaterial) {
+			PreviousTiles.Add(PreviousTile.DynamicMaterial, &PreviousTile);
+		}
+	}
+	for (AActor* WallActor : MyWalls) {
+		AMyActor* MyWall = Cast<AMyActor>(WallActor);
+		const FMyDynamicMat** PreviousTile = PreviousTiles.Find(MyWall->StaticMesh->GetMaterial(M_MAT_NUM));
+		if (!PreviousTile) {
+			continue;
+		}
+		Scheduler->Submit(MyWall, EMyWorkPriority::High, [this, MyWall, Remap, Path = (*PreviousTile)->Path, CleanName = (*PreviousTile)->CleanName, ContentHash = (*PreviousTile)->ContentHash]() {
+			const int32* Index = FileIndices.Find(Path);
+			if (!Index) {
+				Index = DynamicMaterialIndices.Find(CleanName);
+			}
+			if (!Index) {
+				Index = ContentHashIndices.Find(ContentHash);
+			}
+			if (!Index) {
+				MyWall->StaticMesh->SetMaterial(M_MAT_NUM, MyWall->MaterialInterface);
+				Remap->bWallsReset = true;
+				return;
+			}
+			// The wall keeps the previous tile until the new one is loaded
+			LoadTile(DynamicMaterialArray[*Index].TileId, [this, WeakWall = TWeakObjectPtr<AMyActor>(MyWall)](const FMyDynamicMat* Tile) {
+				AMyActor* LoadedWall = WeakWall.Get();
+				if (!LoadedWall) {
+					return;
+				}
+				LoadedWall->StaticMesh->SetMaterial(M_MAT_NUM, Tile ? Tile->DynamicMaterial : LoadedWall->MaterialInterface);
+				FString* SavedTile = SaveMap.Find(LoadedWall);
+				if (Tile && SavedTile) {
+					*SavedTile = Tile->CleanName.ToString();
+				}
+			});
+			Remap->RemappedCount++;
+		});
+	}
+	
+	RetireTiles(MoveTemp(StagedDynamicMaterialArray));
+	StagedDynamicMaterialArray.Reset();
+	StagedCatalog = FMyStagedCatalog();
+	LibraryMount.Reset();
+	
+	RegisterDirectoryWatchers();
+	UE_LOG(LogTemp, Display, TEXT("Mounted %d tiles from %s"), DynamicMaterialArray.Num(), *FString::Join(LibraryRoots, TEXT(", ")));
+	Scheduler->Submit(this, EMyWorkPriority::High, [this, Remap]() {
+		MyReferenceManager->MyHUD->RefreshTilesWidget(DynamicMaterialArray);
+		MyReferenceManager->MyHUD->Notify(Info, FText::Format(RetrieveDataTableMessage(LibraryMounted), DynamicMaterialArray.Num(), Remap->RemappedCount));
+		if (Remap->bWallsReset) {
+			MyReferenceManager->MyHUD->Notify(Warning, RetrieveDataTableMessage(PlacedTexturesDeleted));
+		}
+		if (bLoadGamePending) {
+			bLoadGamePending = false;
+			LoadGame();
+		}
+	});
+}
 
-	// Add to FoundFiles all the images from the hardcoded directory
-	FileManager.FindFiles(FoundFiles, *ResourcesDirPath, *FString("png"));
-	FileManager.FindFiles(FoundFiles, *ResourcesDirPath, *FString("jpg"));
-	FileManager.FindFiles(FoundFiles, *ResourcesDirPath, *FString("jpeg"));
+/**
+ * Stops the library mount in progress and releases the tiles created for it. The tasks still running only read their
+ * inputs, so their results are dropped rather than waited for
+ */
+void AMyController::CancelLibraryMount() {
+	if (!LibraryMount) {
+		return;
+	}
+	FTSTicker::GetCoreTicker().RemoveTicker(LibraryMountTickerHandle);
+	LibraryMountTickerHandle.Reset();
+	LibraryMountGeneration++;
+	
+	RetireTiles(MoveTemp(StagedDynamicMaterialArray));
+	StagedDynamicMaterialArray.Reset();
+	StagedCatalog = FMyStagedCatalog();
+	LibraryMount.Reset();
+	UE_LOG(LogTemp, Display, TEXT("Library mount cancelled"));
+}
+
+/**
+ * Hands tiles that left the catalogs to the frame scheduler, which releases them a batch per work item
+ * @param Tiles Tiles of a replaced library or of a cancelled mount
+ */
+void AMyController::RetireTiles(TArray<FMyDynamicMat>&& Tiles) {
+	UMyFrameScheduler* Scheduler = UMyFrameScheduler::Get(this);
+	for (int32 BatchStart = 0; BatchStart < Tiles.Num(); BatchStart += M_TILE_RELEASE_BATCH_SIZE) {
+		Scheduler->Submit(this, EMyWorkPriority::Low, [this]() {
+			ReleaseRetiredTiles();
+		});
+	}
+	RetiredDynamicMaterialArray.Append(MoveTemp(Tiles));
+}
 
-	for (FString FileName : FoundFiles) {
-		const FString FilePath = ResourcesDirPath + FileName;
-		InsertItemToDynamicMaterialArray(FilePath);
+/**
+ * Releases a batch of the tiles handed to RetireTiles(), the walls being checked once for the whole batch
+ */
+void AMyController::ReleaseRetiredTiles() {
+	const int32 Count = FMath::Min(M_TILE_RELEASE_BATCH_SIZE, RetiredDynamicMaterialArray.Num());
+	const int32 BatchStart = RetiredDynamicMaterialArray.Num() - Count;
+	const TSet<const UMaterialInterface*> WallMaterials = GetWallMaterials();
+	for (int32 Index = BatchStart; Index < RetiredDynamicMaterialArray.Num(); Index++) {
+		FMyStats::TileRemoved(RetiredDynamicMaterialArray[Index]);
+		ReleaseTileMaterial(RetiredDynamicMaterialArray[Index], WallMaterials);
 	}
+	RetiredDynamicMaterialArray.RemoveAt(BatchStart, Count, false);
 }
 
 /**
  * Adds a new FMyDynamicMat entry to MyDynamicMatArray
- * @param FilePath Source from where the new FMyDynamicMat entry is populated from
+ * @param TileSet Files from where the new FMyDynamicMat entry is populated from
+ */
+void AMyController::InsertItemToDynamicMaterialArray(const FMyTileSetFiles& TileSet) {
+	FMyDecodedTile DecodedTile;
+	DecodedTile.FilePath = TileSet.AlbedoPath;
+	DecodedTile.NormalPath = TileSet.NormalPath;
+	DecodedTile.RoughnessPath = TileSet.RoughnessPath;
+	DecodeTile(DecodedTile);
+	AddDecodedTile(DecodedTile, GetLiveCatalog());
+}
+
+/**
+ * Adds several FMyDynamicMat entries to MyDynamicMatArray. Files are read, hashed, decoded and analysed in parallel on
+ * worker threads, by batches to bound the memory held by decoded images, and only the textures and materials are
+ * created on the game thread
+ * @param TileSets Files from where the new FMyDynamicMat entries are populated from
+ */
+void AMyController::InsertItemsToDynamicMaterialArray(const TArray<FMyTileSetFiles>& TileSets) {
+	for (int32 BatchStart = 0; BatchStart < TileSets.Num(); BatchStart += M_IMPORT_BATCH_SIZE) {
+		const int32 BatchSize = FMath::Min(M_IMPORT_BATCH_SIZE, TileSets.Num() - BatchStart);
+		TArray<FMyDecodedTile> DecodedTiles = DecodeTiles(TArray<FMyTileSetFiles>(TileSets.GetData() + BatchStart, BatchSize));
+		for (FMyDecodedTile& DecodedTile : DecodedTiles) {
+			AddDecodedTile(DecodedTile, GetLiveCatalog());
+		}
+	}
+}
+
+/**
+ * Decodes tile sets in parallel, one job per set, see DecodeTile()
+ * @param TileSets Files of the sets
+ * @return The decoded tiles, in the same order
  */
-void AMyController::InsertItemToDynamicMaterialArray(const FString& FilePath) {
-	// Create Texture2D from image
-	UTexture2D* Texture = UKismetRenderingLibrary::ImportFileAsTexture2D(nullptr, *FilePath);
+TArray<AMyController::FMyDecodedTile> AMyController::DecodeTiles(const TArray<FMyTileSetFiles>& TileSets) {
+	TArray<FMyDecodedTile> DecodedTiles;
+	DecodedTiles.SetNum(TileSets.Num());
+	ParallelFor(DecodedTiles.Num(), [&DecodedTiles, &TileSets](const int32 Index) {
+		DecodedTiles[Index].FilePath = TileSets[Index].AlbedoPath;
+		DecodedTiles[Index].NormalPath = TileSets[Index].NormalPath;
+		DecodedTiles[Index].RoughnessPath = TileSets[Index].RoughnessPath;
+		DecodeTile(DecodedTiles[Index]);
+	});
+	return DecodedTiles;
+}
+
+/**
+ * Reads a tile file, hashes its content so the tile can be found again if it is renamed, decodes it and computes its
+ * color signature and perceptual hash on a shrunk copy. The maps of a tile set are decoded in the same job, reusing
+ * its file buffer. Only touches the given tile, so it is safe to call from worker threads
+ * @param DecodedTile Tile whose FilePath, and map paths for a tile set, are set, filled with the results
+ */
+void AMyController::DecodeTile(FMyDecodedTile& DecodedTile) {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_ImportDecode);
+	TArray64<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *DecodedTile.FilePath)) {
+		UE_LOG(LogTemp, Warning, TEXT("Could not read %s"), *DecodedTile.FilePath);
+		return;
+	}
+	DecodedTile.ContentHash = FXxHash64::HashBuffer(FileData.GetData(), FileData.Num()).Hash;
+	if (!FImageUtils::DecompressImage(FileData.GetData(), FileData.Num(), DecodedTile.Image)) {
+		UE_LOG(LogTemp, Warning, TEXT("Could not decode %s"), *DecodedTile.FilePath);
+		return;
+	}
+	DecodedTile.PixelCount = static_cast<int64>(DecodedTile.Image.SizeX) * DecodedTile.Image.SizeY;
+	DecodedTile.bDecoded = true;
+
+	// The tile is analysed on 8 bit sRGB pixels, converted from the decoded format when it differs
+	FImage BGRAImage;
+	const FImage* AnalysedImage = &DecodedTile.Image;
+	if (DecodedTile.Image.Format != ERawImageFormat::BGRA8 || DecodedTile.Image.GammaSpace != EGammaSpace::sRGB) {
+		DecodedTile.Image.CopyTo(BGRAImage, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+		AnalysedImage = &BGRAImage;
+	}
+	TArray<FColor> SmallPixels;
+	int32 SmallWidth, SmallHeight;
+	FMyImageKernels::BoxDownsample(AnalysedImage->AsBGRA8().GetData(), AnalysedImage->SizeX, AnalysedImage->SizeY,
+		FMyImageKernels::GetDownsampleFactor(AnalysedImage->SizeX, M_TILE_ANALYSIS_SIZE), SmallPixels, SmallWidth, SmallHeight);
+	DecodedTile.ColorSignature = FMyColorSignature::Compute(SmallPixels.GetData(), SmallWidth, SmallHeight);
+	DecodedTile.PerceptualHash = FMyImageKernels::ComputeDifferenceHash(SmallPixels.GetData(), SmallWidth, SmallHeight);
+	if (SmallWidth < DecodedTile.Image.SizeX) {
+		DecodedTile.PreviewImage.Init(SmallWidth, SmallHeight, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+		FMemory::Memcpy(DecodedTile.PreviewImage.RawData.GetData(), SmallPixels.GetData(), SmallPixels.Num() * sizeof(FColor));
+	}
+
+	// Maps hold normals and masks rather than colors, so they are flagged linear to be sampled without gamma correction
+	const auto DecodeMap = [&FileData](const FString& MapPath, FImage& OutImage) {
+		if (MapPath.IsEmpty()) {
+			return;
+		}
+		if (!FFileHelper::LoadFileToArray(FileData, *MapPath) || !FImageUtils::DecompressImage(FileData.GetData(), FileData.Num(), OutImage)) {
+			UE_LOG(LogTemp, Warning, TEXT("Could not decode %s"), *MapPath);
+			OutImage = FImage();
+			return;
+		}
+		OutImage.GammaSpace = EGammaSpace::Linear;
+	};
+	DecodeMap(DecodedTile.NormalPath, DecodedTile.NormalImage);
+	DecodeMap(DecodedTile.RoughnessPath, DecodedTile.RoughnessImage);
+}
+
+/**
+ * Adds a decoded tile to MyDynamicMatArray. A tile that is a near-duplicate of a tile already there (same picture and
+ * colors, other resolution or compression) joins its group, and only the largest tile of a group is shown in the
+ * picker and loaded upfront, the others being loaded when used. Must run on the game thread
+ * @param DecodedTile Tile returned by DecodeTile(), its image is released
+ * @param Catalog Catalog the tile is added to, the live one or the staged one of a library being mounted
+ */
+void AMyController::AddDecodedTile(FMyDecodedTile& DecodedTile, const FMyCatalogView& Catalog) {
+	if (!DecodedTile.bDecoded) {
+		return;
+	}
+	const FString& FilePath = DecodedTile.FilePath;
 	const FString BaseFileName = FPaths::GetCleanFilename(*FilePath);
-	Texture->AssetImportData->AddFileName(BaseFileName, 0);
-	
-	// Create dynamic material based on the previous texture
-	UMaterialInstanceDynamic* DynamicMaterial = UMaterialInstanceDynamic::Create(BaseMaterial, nullptr);
-	DynamicMaterial->SetTextureParameterValue(FName("TextureParameter"), Texture);
 
 	// Create, populate and store struct with the desired information
 	FMyDynamicMat MyDynamicMatStruct;
 	
-	MyDynamicMatStruct.CleanName = FName(*BaseFileName);
+	MyDynamicMatStruct.CleanName = MakeUniqueTileName(FilePath, Catalog);
 	MyDynamicMatStruct.Path = *FilePath;
-	MyDynamicMatStruct.Texture2D = Texture;
-	MyDynamicMatStruct.DynamicMaterial = DynamicMaterial;
+	MyDynamicMatStruct.NormalPath = DecodedTile.NormalPath;
+	MyDynamicMatStruct.RoughnessPath = DecodedTile.RoughnessPath;
+	MyDynamicMatStruct.ContentHash = DecodedTile.ContentHash;
+	MyDynamicMatStruct.TileId = NextTileId++;
+	MyDynamicMatStruct.ColorSignature = DecodedTile.ColorSignature;
+	MyDynamicMatStruct.PerceptualHash = DecodedTile.PerceptualHash;
+	MyDynamicMatStruct.PixelCount = DecodedTile.PixelCount;
+	MyDynamicMatStruct.TilePack = DecodedTile.TilePack;
+	MyDynamicMatStruct.PackEntry = DecodedTile.PackEntry;
+
+	const int32 GroupId = FindDuplicateGroup(MyDynamicMatStruct, Catalog);
+	const bool bRepresentative = GroupId == INDEX_NONE
+		|| MyDynamicMatStruct.PixelCount > Catalog.DynamicMaterialArray[Catalog.TileIdIndices[GroupId]].PixelCount;
+	if (bRepresentative && !CreateTileMaterial(MyDynamicMatStruct, DecodedTile)) {
+		UE_LOG(LogTemp, Warning, TEXT("Could not create a texture for %s"), *FilePath);
+		return;
+	}
+	DecodedTile.Image = FImage();
+	DecodedTile.NormalImage = FImage();
+	DecodedTile.RoughnessImage = FImage();
+	DecodedTile.PreviewImage = FImage();
 	
-	DynamicMaterialArray.Add(MyDynamicMatStruct);
+	const int32 Index = Catalog.DynamicMaterialArray.Add(MyDynamicMatStruct);
+	Catalog.DynamicMaterialIndices.Add(MyDynamicMatStruct.CleanName, Index);
+	Catalog.ContentHashIndices.Add(MyDynamicMatStruct.ContentHash, Index);
+	Catalog.TileIdIndices.Add(MyDynamicMatStruct.TileId, Index);
+	for (const FString& TileFile : {MyDynamicMatStruct.Path, MyDynamicMatStruct.NormalPath, MyDynamicMatStruct.RoughnessPath}) {
+		if (!TileFile.IsEmpty()) {
+			Catalog.FileIndices.Add(TileFile, Index);
+		}
+	}
+	Catalog.TileNameIndex.Add(MyDynamicMatStruct.TileId, BaseFileName, GetTileKeywords(FilePath, Catalog.LibraryRoots));
+	Catalog.DuplicateIndex.Add(MyDynamicMatStruct.TileId, MyDynamicMatStruct.PerceptualHash);
+	
+	TArray<int32> Members;
+	if (GroupId != INDEX_NONE) {
+		Catalog.TileGroups.RemoveAndCopyValue(GroupId, Members);
+		if (!bRepresentative) {
+			UE_LOG(LogTemp, Display, TEXT("%s is a near-duplicate of %s"), *BaseFileName, *Catalog.DynamicMaterialArray[Catalog.TileIdIndices[GroupId]].CleanName.ToString());
+		}
+	}
+	Members.Add(MyDynamicMatStruct.TileId);
+	SetGroupRepresentative(MoveTemp(Members), bRepresentative ? MyDynamicMatStruct.TileId : GroupId, Catalog);
+	FMyStats::TileAdded(MyDynamicMatStruct);
 }
 
 /**
- * Returns the StaticMeshComponent of the SelectedWall variable
- * @return The SelectedWall StaticMeshComponent 
+ * Names a tile after its file, unless a tile of the catalog already has that name, which happens with files of the same
+ * name in several library roots: the name is then qualified with the tile's root folder, and numbered if still taken.
+ * The name is what the widgets, the input recordings and the save file know the tile by
+ * @param FilePath Path of the tile's file
+ * @param Catalog Catalog the tile is added to
+ * @return The CleanName of the tile, unique within the catalog
  */
-UStaticMeshComponent* AMyController::GetSelectedWallStaticMeshComponent() const {
-	if (SelectedWall) {
-		TArray<UStaticMeshComponent*> Components;
-        		
-		SelectedWall->GetComponents<UStaticMeshComponent>(Components);
-		for(int i = 0; i < Components.Num(); i++) {
-			UStaticMeshComponent* StaticMeshComponent = Components[i];
-			return StaticMeshComponent;
+FName AMyController::MakeUniqueTileName(const FString& FilePath, const FMyCatalogView& Catalog) {
+	const FString FileName = FPaths::GetCleanFilename(FilePath);
+	if (!Catalog.DynamicMaterialIndices.Contains(FName(*FileName))) {
+		return FName(*FileName);
+	}
+	// Roots are not scanned recursively, so the folder of the file is its root
+	const FString QualifiedName = FPaths::GetCleanFilename(FPaths::GetPath(FilePath)) / FileName;
+	FName TileName(*QualifiedName);
+	for (int32 Suffix = 2; Catalog.DynamicMaterialIndices.Contains(TileName); Suffix++) {
+		TileName = FName(*FString::Printf(TEXT("%s (%d)"), *QualifiedName, Suffix));
+	}
+	return TileName;
+}
+
+/**
+ * Creates the textures and the dynamic material of a tile. The maps of a tile set are bound to the same material
+ * instance as its albedo, so a set costs a single material instance. Only a preview of the albedo made of its low mips
+ * is uploaded at once, so the tile shows, blurry, straight away: its full resolution texture and its maps are left to
+ * the texture uploader, which sharpens the tile within the upload budget of the following frames
+ * @param DynamicMat Tile whose textures and DynamicMaterial are set
+ * @param DecodedTile Decoded images of the tile, ignored for a packed tile. Its images are moved to the upload
+ * @return False if the texture could not be created
+ */
+bool AMyController::CreateTileMaterial(FMyDynamicMat& DynamicMat, FMyDecodedTile& DecodedTile) {
+	// Create Texture2D from the pack's thumbnail mip or the preview image, reusing a pooled one
+	UMyTilePool* TilePool = UMyTilePool::Get(this);
+	const FMyTilePackEntry* PackEntry = DynamicMat.TilePack ? &DynamicMat.TilePack->GetEntries()[DynamicMat.PackEntry] : nullptr;
+	const bool bPreview = PackEntry ? PackEntry->ThumbnailMip > 0 : DecodedTile.PreviewImage.GetNumPixels() > 0;
+	UTexture2D* Texture;
+	{
+		MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_TextureCreation);
+		if (PackEntry) {
+			Texture = DynamicMat.TilePack->CreateTexture(*TilePool, DynamicMat.PackEntry, bPreview ? PackEntry->ThumbnailMip : 0);
+		} else {
+			Texture = TilePool->CreateTexture(bPreview ? DecodedTile.PreviewImage : DecodedTile.Image);
 		}
 	}
-	return nullptr;
+	if (!Texture) {
+		return false;
+	}
+	// Only the albedo is named after the tile, so the save file finds the tile among the textures of its material
+	Texture->AssetImportData->AddFileName(FPaths::GetCleanFilename(DynamicMat.Path), 0);
+	
+	// Create dynamic material based on the previous texture
+	UMaterialInstanceDynamic* DynamicMaterial;
+	{
+		MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_MIDCreation);
+		DynamicMaterial = TilePool->CreateMaterial(BaseMaterial);
+		DynamicMaterial->SetTextureParameterValue(FName("TextureParameter"), Texture);
+	}
+	DynamicMat.Texture2D = Texture;
+	DynamicMat.NormalTexture = nullptr;
+	DynamicMat.RoughnessTexture = nullptr;
+	DynamicMat.DynamicMaterial = DynamicMaterial;
+	
+	FMyTileUpload Upload;
+	Upload.TileId = DynamicMat.TileId;
+	Upload.DynamicMaterial = DynamicMaterial;
+	Upload.Path = DynamicMat.Path;
+	Upload.TilePack = DynamicMat.TilePack;
+	Upload.PackEntry = DynamicMat.PackEntry;
+	Upload.bFullTexture = bPreview;
+	int64 UploadBytes = 0;
+	if (bPreview && PackEntry) {
+		for (const FMyTilePackMip& Mip : PackEntry->Mips) {
+			UploadBytes += Mip.Size;
+		}
+	} else if (bPreview) {
+		Upload.Image = MoveTemp(DecodedTile.Image);
+		UploadBytes += Upload.Image.RawData.Num();
+	}
+	Upload.NormalImage = MoveTemp(DecodedTile.NormalImage);
+	Upload.RoughnessImage = MoveTemp(DecodedTile.RoughnessImage);
+	UploadBytes += Upload.NormalImage.RawData.Num() + Upload.RoughnessImage.RawData.Num();
+	if (UploadBytes > 0) {
+		UMyTextureUploader::Get(this)->Submit(DynamicMaterial, UploadBytes, [this, Upload = MoveTemp(Upload)]() mutable {
+			UploadTileTextures(Upload);
+		});
+	}
+	return true;
 }
 
+/**
+ * Replaces the preview of a tile by its full resolution texture and binds the textures of its maps, when the texture
+ * uploader gets to it. The tile may be in the catalog or in the staged catalog of a library mount. A tile that has left
+ * both meanwhile still had its material kept by a wall, see ReleaseTileMaterial(), which gets the textures all the same
+ * @param Upload Textures of the tile, its images are consumed
+ */
+void AMyController::UploadTileTextures(FMyTileUpload& Upload) {
+	UMaterialInstanceDynamic* DynamicMaterial = Upload.DynamicMaterial.Get();
+	if (!DynamicMaterial) {
+		return;
+	}
+	const int32* Index = TileIdIndices.Find(Upload.TileId);
+	FMyDynamicMat* DynamicMat = Index ? &DynamicMaterialArray[*Index] : nullptr;
+	if (!DynamicMat) {
+		Index = StagedCatalog.TileIdIndices.Find(Upload.TileId);
+		DynamicMat = Index ? &StagedDynamicMaterialArray[*Index] : nullptr;
+	}
+	// Reloaded since with another material
+	if (DynamicMat && DynamicMat->DynamicMaterial != DynamicMaterial) {
+		DynamicMat = nullptr;
+	}
+	
+	UMyTilePool* TilePool = UMyTilePool::Get(this);
+	UTexture2D* PreviewTexture = nullptr;
+	{
+		MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_TextureCreation);
+		if (Upload.bFullTexture) {
+			UTexture2D* Texture = Upload.TilePack ? Upload.TilePack->CreateTexture(*TilePool, Upload.PackEntry) : TilePool->CreateTexture(Upload.Image);
+			if (Texture) {
+				Texture->AssetImportData->AddFileName(FPaths::GetCleanFilename(Upload.Path), 0);
+				DynamicMaterial->SetTextureParameterValue(FName("TextureParameter"), Texture);
+				if (DynamicMat) {
+					PreviewTexture = DynamicMat->Texture2D;
+					DynamicMat->Texture2D = Texture;
+				}
+			}
+		}
+		if (Upload.NormalImage.GetNumPixels() > 0) {
+			UTexture2D* NormalTexture = TilePool->CreateTexture(Upload.NormalImage);
+			NormalTexture->CompressionSettings = TC_Normalmap;
+			DynamicMaterial->SetTextureParameterValue(FName("NormalParameter"), NormalTexture);
+			if (DynamicMat) {
+				DynamicMat->NormalTexture = NormalTexture;
+			}
+		}
+		if (Upload.RoughnessImage.GetNumPixels() > 0) {
+			UTexture2D* RoughnessTexture = TilePool->CreateTexture(Upload.RoughnessImage);
+			RoughnessTexture->CompressionSettings = TC_Masks;
+			DynamicMaterial->SetTextureParameterValue(FName("RoughnessParameter"), RoughnessTexture);
+			if (DynamicMat) {
+				DynamicMat->RoughnessTexture = RoughnessTexture;
+			}
+		}
+	}
+	// The textures of a tile out of the catalog go to the garbage collector with the material, the preview included
+	if (!DynamicMat) {
+		return;
+	}
+	FMyStats::TileUploaded(*DynamicMat, PreviewTexture);
+	
+	// The picker shows the preview until told otherwise, it can only be reused once replaced there too
+	if (PreviewTexture) {
+		if (MyReferenceManager && MyReferenceManager->MyHUD) {
+			MyReferenceManager->MyHUD->TileUpdated(*DynamicMat);
+		}
+		TilePool->ReleaseTexture(PreviewTexture);
+	}
+}
+
+/**
+ * Returns the materials the walls show, which the tiles released meanwhile must not hand to the tile pool
+ * @return The material of every wall
+ */
+TSet<const UMaterialInterface*> AMyController::GetWallMaterials() const {
+	TSet<const UMaterialInterface*> WallMaterials;
+	WallMaterials.Reserve(MyWalls.Num());
+	for (AActor* WallActor : MyWalls) {
+		WallMaterials.Add(Cast<AMyActor>(WallActor)->StaticMesh->GetMaterial(M_MAT_NUM));
+	}
+	return WallMaterials;
+}
+
+/**
+ * Hands the textures and material of a tile leaving the catalog to the tile pool, for the next tiles to reuse, and drops
+ * its pending upload. They are left to the garbage collector instead while a wall still shows the material, whose
+ * upload then still runs so the wall does not keep the preview
+ * @param DynamicMat Tile leaving the catalog
+ * @param WallMaterials Materials shown by the walls, see GetWallMaterials(), gathered once for tiles released together
+ */
+void AMyController::ReleaseTileMaterial(const FMyDynamicMat& DynamicMat, const TSet<const UMaterialInterface*>& WallMaterials) const {
+	UMyTilePool* TilePool = UMyTilePool::Get(this);
+	if (!DynamicMat.DynamicMaterial || !TilePool) {
+		return;
+	}
+	if (WallMaterials.Contains(DynamicMat.DynamicMaterial)) {
+		return;
+	}
+	if (UMyTextureUploader* TextureUploader = UMyTextureUploader::Get(this)) {
+		TextureUploader->Cancel(DynamicMat.DynamicMaterial);
+	}
+	TilePool->ReleaseMaterial(DynamicMat.DynamicMaterial);
+	TilePool->ReleaseTexture(DynamicMat.Texture2D);
+	TilePool->ReleaseTexture(DynamicMat.NormalTexture);
+	TilePool->ReleaseTexture(DynamicMat.RoughnessTexture);
+}
 
 /**
- * Updates the selected wall with the selected material
+ * Creates the texture and material of a tile that was not loaded on import because it is a near-duplicate. A tile
+ * loaded from its image file is decoded by a task, like the tiles of an import, and its material created by the frame
+ * scheduler once decoded; further requests for a tile being loaded wait for the same decode
+ * @param TileId TileId of the tile
+ * @param OnLoaded Called with the tile once loaded, right away if it already is. Must not add or remove tiles. May be
+ * unset
+ */
+void AMyController::LoadTile(const int32 TileId, FMyOnTileLoaded&& OnLoaded) {
+	const int32* Index = TileIdIndices.Find(TileId);
+	const FMyDynamicMat* DynamicMat = Index ? &DynamicMaterialArray[*Index] : nullptr;
+	if (!DynamicMat || DynamicMat->DynamicMaterial) {
+		if (OnLoaded) {
+			OnLoaded(DynamicMat);
+		}
+		return;
+	}
+	
+	const bool bLoading = TileLoads.Contains(TileId);
+	TArray<FMyOnTileLoaded>& Requests = TileLoads.FindOrAdd(TileId);
+	if (OnLoaded) {
+		Requests.Add(MoveTemp(OnLoaded));
+	}
+	if (bLoading) {
+		return;
+	}
+	
+	// A packed tile is created from its pack without decoding
+	FMyDecodedTile DecodedTile;
+	if (DynamicMat->TilePack) {
+		FinishTileLoad(TileId, DecodedTile);
+		return;
+	}
+	DecodedTile.FilePath = DynamicMat->Path;
+	DecodedTile.NormalPath = DynamicMat->NormalPath;
+	DecodedTile.RoughnessPath = DynamicMat->RoughnessPath;
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis = TWeakObjectPtr<AMyController>(this), TileId, DecodedTile = MoveTemp(DecodedTile)]() mutable {
+		DecodeTile(DecodedTile);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, TileId, DecodedTile = MoveTemp(DecodedTile)]() mutable {
+			if (AMyController* This = WeakThis.Get()) {
+				UMyFrameScheduler::Get(This)->Submit(This, EMyWorkPriority::High, [This, TileId, DecodedTile = MoveTemp(DecodedTile)]() mutable {
+					This->FinishTileLoad(TileId, DecodedTile);
+				});
+			}
+		});
+	});
+}
+
+/**
+ * Creates the texture and material of a tile loaded by LoadTile() and answers the requests waiting for it. The tile
+ * may have been removed while it was decoded
+ * @param TileId TileId of the tile
+ * @param DecodedTile Decoded images of the tile, ignored for a packed tile
+ */
+void AMyController::FinishTileLoad(const int32 TileId, FMyDecodedTile& DecodedTile) {
+	TArray<FMyOnTileLoaded> Requests;
+	if (TArray<FMyOnTileLoaded>* Found = TileLoads.Find(TileId)) {
+		Requests = MoveTemp(*Found);
+		TileLoads.Remove(TileId);
+	}
+	
+	const int32* Index = TileIdIndices.Find(TileId);
+	FMyDynamicMat* DynamicMat = Index ? &DynamicMaterialArray[*Index] : nullptr;
+	if (DynamicMat && !DynamicMat->DynamicMaterial) {
+		if ((!DynamicMat->TilePack && !DecodedTile.bDecoded) || !CreateTileMaterial(*DynamicMat, DecodedTile)) {
+			UE_LOG(LogTemp, Warning, TEXT("Could not load %s"), *DynamicMat->Path);
+			DynamicMat = nullptr;
+		} else {
+			FMyStats::TileLoaded(*DynamicMat);
+			// A near-duplicate that took the place of a removed representative may already be in the picker
+			if (DynamicMat->IsRepresentative() && MyReferenceManager && MyReferenceManager->MyHUD) {
+				MyReferenceManager->MyHUD->TileUpdated(*DynamicMat);
+			}
+		}
+	}
+	for (FMyOnTileLoaded& OnLoaded : Requests) {
+		OnLoaded(DynamicMat);
+	}
+}
+
+/**
+ * Looks for a tile in the DynamicMaterialArray by its file name and loads it if it has not been yet, see LoadTile()
+ * @param CleanName File name of the tile, with extension
+ * @param OnLoaded Called with the tile once loaded, nullptr if it is not in the DynamicMaterialArray or could not be
+ * loaded
+ */
+void AMyController::LoadDynamicMaterial(const FName CleanName, FMyOnTileLoaded&& OnLoaded) {
+	const FMyDynamicMat* DynamicMat = FindDynamicMaterial(CleanName);
+	if (!DynamicMat) {
+		if (OnLoaded) {
+			OnLoaded(nullptr);
+		}
+		return;
+	}
+	LoadTile(DynamicMat->TileId, MoveTemp(OnLoaded));
+}
+
+/**
+ * Looks for the group of near-duplicates a tile belongs to: tiles whose perceptual hash is a few bits away and whose
+ * mean color is close, since tiles differing only by color have the same hash. The hash of a flat or low-contrast tile
+ * has hardly any bit set whatever its color, so such tiles are only grouped when their colors nearly match, otherwise
+ * plain colors as close as white and ivory would be grouped
+ * @param DynamicMat Tile not yet in the catalog
+ * @param Catalog Catalog the tile is being added to
+ * @return TileId of the representative of the closest tile's group, INDEX_NONE if the tile has no near-duplicate
+ */
+int32 AMyController::FindDuplicateGroup(const FMyDynamicMat& DynamicMat, const FMyCatalogView& Catalog) {
+	if (!DynamicMat.ColorSignature.bValid) {
+		return INDEX_NONE;
+	}
+	TArray<int32> Candidates;
+	Catalog.DuplicateIndex.FindWithin(DynamicMat.PerceptualHash, M_DUPLICATE_MAX_HASH_DISTANCE, Candidates);
+	const int32 HashBits = static_cast<int32>(FMath::CountBits(DynamicMat.PerceptualHash));
+	
+	int32 GroupId = INDEX_NONE;
+	float BestDistance = MAX_flt;
+	for (const int32 Candidate : Candidates) {
+		const FMyDynamicMat& CandidateMat = Catalog.DynamicMaterialArray[Catalog.TileIdIndices[Candidate]];
+		const bool bFlat = FMath::Min(HashBits, static_cast<int32>(FMath::CountBits(CandidateMat.PerceptualHash))) < M_DUPLICATE_MIN_HASH_BITS;
+		const float ColorDistance = FVector3f::Dist(CandidateMat.ColorSignature.MeanLab, DynamicMat.ColorSignature.MeanLab);
+		if (!CandidateMat.ColorSignature.bValid || ColorDistance > (bFlat ? M_DUPLICATE_MAX_FLAT_COLOR_DISTANCE : M_DUPLICATE_MAX_COLOR_DISTANCE)) {
+			continue;
+		}
+		if (bFlat && CandidateMat.ColorSignature.GetHistogramDistance(DynamicMat.ColorSignature) > M_DUPLICATE_MAX_FLAT_HISTOGRAM_DISTANCE) {
+			continue;
+		}
+		// Bits count first, color breaks ties
+		const float Distance = FMyTileDuplicateIndex::GetDistance(CandidateMat.PerceptualHash, DynamicMat.PerceptualHash) * M_DUPLICATE_MAX_COLOR_DISTANCE + ColorDistance;
+		if (Distance < BestDistance) {
+			BestDistance = Distance;
+			GroupId = CandidateMat.RepresentativeId;
+		}
+	}
+	return GroupId;
+}
+
+/**
+ * Records a group of near-duplicates and the tile shown for it
+ * @param Members TileIds of the group
+ * @param RepresentativeId TileId of the tile shown for the group, one of the Members
+ * @param Catalog Catalog of the group
+ */
+void AMyController::SetGroupRepresentative(TArray<int32>&& Members, const int32 RepresentativeId, const FMyCatalogView& Catalog) {
+	for (const int32 Member : Members) {
+		if (const int32* Index = Catalog.TileIdIndices.Find(Member)) {
+			Catalog.DynamicMaterialArray[*Index].RepresentativeId = RepresentativeId;
+		}
+	}
+	Catalog.TileGroups.Add(RepresentativeId, MoveTemp(Members));
+}
+
+/**
+ * Replaces TileIds by the TileIds of their group's representative, keeping the first occurrence of each
+ * @param TileIds TileIds to replace
+ */
+void AMyController::GetRepresentatives(TArray<int32>& TileIds) const {
+	TSet<int32> Seen;
+	int32 Count = 0;
+	for (const int32 TileId : TileIds) {
+		const int32* Index = TileIdIndices.Find(TileId);
+		const int32 RepresentativeId = Index ? DynamicMaterialArray[*Index].RepresentativeId : TileId;
+		bool bAlreadySeen;
+		Seen.Add(RepresentativeId, &bAlreadySeen);
+		if (!bAlreadySeen) {
+			TileIds[Count++] = RepresentativeId;
+		}
+	}
+	TileIds.SetNum(Count);
+}
+
+/**
+ * Removes an entry from MyDynamicMatArray and from the indices over it. The last entry takes its place, so only the
+ * indices of these two entries are updated
+ * @param Element Entry to remove, copied by the caller since the array is modified
+ */
+void AMyController::RemoveItemFromDynamicMaterialArray(const FMyDynamicMat& Element) {
+	const int32* Found = TileIdIndices.Find(Element.TileId);
+	if (!Found) {
+		return;
+	}
+	const int32 Index = *Found;
+	FMyStats::TileRemoved(Element);
+	ReleaseTileMaterial(Element, GetWallMaterials());
+	TileNameIndex.Remove(Element.TileId);
+	DuplicateIndex.Remove(Element.TileId);
+	MoveTileIndices(Element, Index, INDEX_NONE);
+	const int32 LastIndex = DynamicMaterialArray.Num() - 1;
+	if (Index != LastIndex) {
+		MoveTileIndices(DynamicMaterialArray[LastIndex], LastIndex, Index);
+	}
+	DynamicMaterialArray.RemoveAtSwap(Index, 1, false);
+
+	// The largest remaining near-duplicate takes the place of a removed representative
+	TArray<int32> Members;
+	TileGroups.RemoveAndCopyValue(Element.RepresentativeId, Members);
+	Members.Remove(Element.TileId);
+	if (Members.IsEmpty()) {
+		return;
+	}
+	int32 RepresentativeId = Element.RepresentativeId;
+	if (Element.IsRepresentative()) {
+		RepresentativeId = *Algo::MaxElementBy(Members, [this](const int32 Member) {
+			return DynamicMaterialArray[TileIdIndices[Member]].PixelCount;
+		});
+	}
+	SetGroupRepresentative(MoveTemp(Members), RepresentativeId, GetLiveCatalog());
+	if (Element.IsRepresentative()) {
+		LoadTile(RepresentativeId);
+	}
+}
+
+/**
+ * Words a tile can be searched by besides its name: its library root's name and its format. Library roots are not
+ * scanned recursively, so a tile has no folders below its root
+ * @param FilePath Path of the tile's file
+ * @param Roots Library roots of the tile's catalog
+ * @return The keywords of the tile
+ */
+TArray<FString> AMyController::GetTileKeywords(const FString& FilePath, const TArray<FString>& Roots) {
+	TArray<FString> Keywords;
+	const FString* Root = Roots.FindByPredicate([&FilePath](const FString& LibraryRoot) {
+		return FilePath.StartsWith(LibraryRoot);
+	});
+	if (Root) {
+		FString RootPath = *Root;
+		RootPath.RemoveFromEnd(TEXT("/"));
+		Keywords.Add(FPaths::GetCleanFilename(RootPath));
+	}
+	Keywords.Add(FPaths::GetExtension(FilePath));
+	return Keywords;
+}
+
+/**
+ * Looks for the tiles whose name, library root or format contain every term of a query
+ * @param Query Space separated terms, matched as substrings regardless of case
+ * @param OutTileIds TileIds of the matching tiles
+ */
+void AMyController::SearchTiles(const FString& Query, TArray<int32>& OutTileIds) const {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_TileSearch);
+	TileNameIndex.Search(Query, OutTileIds);
+	GetRepresentatives(OutTileIds);
+}
+
+/**
+ * Ranks the tiles by how close their colors are to a color, leaving out those too far from it
+ * @param Color Queried color, linear
+ * @param OutTileIds TileIds of the tiles close to the color, closest first
+ */
+void AMyController::RankTilesByColor(const FLinearColor& Color, TArray<int32>& OutTileIds) const {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_ColorSearch);
+	const FVector3f QueryLab = FMyColorSignature::ToLab(Color);
+	TArray<TPair<float, int32>> Ranking;
+	Ranking.Reserve(DynamicMaterialArray.Num());
+	for (const FMyDynamicMat& DynamicMat : DynamicMaterialArray) {
+		if (DynamicMat.ColorSignature.bValid) {
+			const float Distance = DynamicMat.ColorSignature.GetDistance(QueryLab);
+			if (Distance <= M_COLOR_SEARCH_MAX_DISTANCE) {
+				Ranking.Emplace(Distance, DynamicMat.TileId);
+			}
+		}
+	}
+	Ranking.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+	
+	OutTileIds.Reset(Ranking.Num());
+	for (const TPair<float, int32>& Ranked : Ranking) {
+		OutTileIds.Add(Ranked.Value);
+	}
+	GetRepresentatives(OutTileIds);
+}
+
+/**
+ * Looks for a tile in the DynamicMaterialArray by its file name
+ * @param CleanName File name of the tile, with extension
+ * @return The tile, nullptr if it is not in the DynamicMaterialArray
+ */
+const FMyDynamicMat* AMyController::FindDynamicMaterial(const FName CleanName) const {
+	const int32* Index = DynamicMaterialIndices.Find(CleanName);
+	return Index ? &DynamicMaterialArray[*Index] : nullptr;
+}
+
+/**
+ * Re-indexes the whole DynamicMaterialArray by CleanName, content hash, TileId and file, needed when the array is
+ * replaced rather than updated
+ */
+void AMyController::RebuildDynamicMaterialIndices() {
+	DynamicMaterialIndices.Reset();
+	ContentHashIndices.Reset();
+	TileIdIndices.Reset();
+	FileIndices.Reset();
+	for (int32 Index = 0; Index < DynamicMaterialArray.Num(); Index++) {
+		const FMyDynamicMat& DynamicMat = DynamicMaterialArray[Index];
+		DynamicMaterialIndices.Add(DynamicMat.CleanName, Index);
+		ContentHashIndices.Add(DynamicMat.ContentHash, Index);
+		TileIdIndices.Add(DynamicMat.TileId, Index);
+		for (const FString& TileFile : {DynamicMat.Path, DynamicMat.NormalPath, DynamicMat.RoughnessPath}) {
+			if (!TileFile.IsEmpty()) {
+				FileIndices.Add(TileFile, Index);
+			}
+		}
+	}
+}
+
+/**
+ * Points the indices of a tile that moves within the DynamicMaterialArray to its new position. The entries of other
+ * tiles with the same content are left alone, so they are still found once this one is removed
+ * @param DynamicMat Tile that moves
+ * @param FromIndex Position of the tile
+ * @param ToIndex New position of the tile, INDEX_NONE to remove its entries
+ */
+void AMyController::MoveTileIndices(const FMyDynamicMat& DynamicMat, const int32 FromIndex, const int32 ToIndex) {
+	const auto MoveEntry = [FromIndex, ToIndex](auto& Indices, const auto& Key) {
+		int32* Index = Indices.Find(Key);
+		if (Index && *Index == FromIndex) {
+			if (ToIndex == INDEX_NONE) {
+				Indices.Remove(Key);
+			} else {
+				*Index = ToIndex;
+			}
+		}
+	};
+	const auto MoveSharedEntry = [FromIndex, ToIndex](auto& Indices, const auto& Key) {
+		if (int32* Index = Indices.FindPair(Key, FromIndex)) {
+			if (ToIndex == INDEX_NONE) {
+				Indices.RemoveSingle(Key, FromIndex);
+			} else {
+				*Index = ToIndex;
+			}
+		}
+	};
+	MoveEntry(DynamicMaterialIndices, DynamicMat.CleanName);
+	MoveSharedEntry(ContentHashIndices, DynamicMat.ContentHash);
+	MoveEntry(TileIdIndices, DynamicMat.TileId);
+	for (const FString& TileFile : {DynamicMat.Path, DynamicMat.NormalPath, DynamicMat.RoughnessPath}) {
+		if (!TileFile.IsEmpty()) {
+			MoveEntry(FileIndices, TileFile);
+		}
+	}
+}
+
+/**
+ * Re-indexes the whole DynamicMaterialArray for searches and near-duplicates, needed when the array is replaced rather
+ * than updated
+ */
+void AMyController::RebuildTileIndices() {
+	TileNameIndex.Reset();
+	DuplicateIndex.Reset();
+	TileGroups.Reset();
+	for (const FMyDynamicMat& DynamicMat : DynamicMaterialArray) {
+		TileNameIndex.Add(DynamicMat.TileId, DynamicMat.CleanName.ToString(), GetTileKeywords(DynamicMat.Path, LibraryRoots));
+		DuplicateIndex.Add(DynamicMat.TileId, DynamicMat.PerceptualHash);
+		TileGroups.FindOrAdd(DynamicMat.RepresentativeId).Add(DynamicMat.TileId);
+	}
+}
+
+/**
+ * Sets a tile on walls by name and records it in the SaveMap, used to remap walls whose texture is missing
+ * @param WallNames Tag names of the walls
+ * @param TileName CleanName of the tile
+ */
+void AMyController::RemapWalls(const TArray<FString>& WallNames, const FName TileName) {
+	LoadDynamicMaterial(TileName, [this, WallNames, TileName](const FMyDynamicMat* DynamicMat) {
+		const UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this);
+		if (!DynamicMat || !Registry) {
+			return;
+		}
+		
+		for (const FString& WallName : WallNames) {
+			if (AMyActor* MyWall = Registry->FindWall(FName(WallName))) {
+				MyWall->StaticMesh->SetMaterial(M_MAT_NUM, DynamicMat->DynamicMaterial);
+				SaveMap.Add(MyWall, TileName.ToString());
+			}
+		}
+	});
+}
+
+/**
+ * Toggles the selection highlight of a wall. The highlight is read by the wall materials from the custom primitive
+ * data, which only updates the primitive's uniform data instead of rebuilding its scene proxy like custom depth does
+ * @param MyWall Wall to update
+ * @param bHighlighted Whether the wall must be displayed as selected
+ */
+void AMyController::SetWallHighlighted(const AMyActor* MyWall, const bool bHighlighted) const {
+	if (MyWall && MyWall->StaticMesh) {
+		MyWall->StaticMesh->SetCustomPrimitiveDataFloat(M_CPD_SELECTED, bHighlighted ? 1.f : 0.f);
+	}
+}
+
+/**
+ * Sets the tile transform of the selected walls. The transform is custom primitive data read by BaseMaterial, so no
+ * material instance is created per wall
+ * @param TileTransform Scale, rotation, offset and grout of the tiles
+ */
+void AMyController::SetTileTransform(const FMyTileTransform& TileTransform) {
+	for (AMyActor* MyWall : SelectedWalls) {
+		if (!MyWall) {
+			continue;
+		}
+		if (TileTransform == FMyTileTransform()) {
+			WallTileTransforms.Remove(TSoftObjectPtr<AMyActor>(MyWall));
+		} else {
+			WallTileTransforms.Add(TSoftObjectPtr<AMyActor>(MyWall), TileTransform);
+		}
+		ApplyTileTransform(MyWall, TileTransform);
+	}
+}
+
+/**
+ * Returns the tile transform of a wall
+ * @param MyWall Wall whose tile transform is requested
+ * @return The tile transform of the wall, the default one if it has not been changed
+ */
+FMyTileTransform AMyController::GetTileTransform(const AMyActor* MyWall) const {
+	const FMyTileTransform* TileTransform = WallTileTransforms.Find(TSoftObjectPtr<AMyActor>(FSoftObjectPath(MyWall)));
+	return TileTransform ? *TileTransform : FMyTileTransform();
+}
+
+/**
+ * Writes a tile transform in the custom primitive data of a wall, next to the selection highlight
+ * @param MyWall Wall to update
+ * @param TileTransform Tile transform of the wall
+ */
+void AMyController::ApplyTileTransform(const AMyActor* MyWall, const FMyTileTransform& TileTransform) {
+	if (MyWall && MyWall->StaticMesh) {
+		MyWall->StaticMesh->SetCustomPrimitiveDataVector4(M_CPD_TILE_TRANSFORM, FVector4(TileTransform.Scale, TileTransform.Rotation, TileTransform.Offset.X, TileTransform.Offset.Y));
+		MyWall->StaticMesh->SetCustomPrimitiveDataVector4(M_CPD_GROUT, FVector4(TileTransform.GroutWidth, TileTransform.GroutColor.R, TileTransform.GroutColor.G, TileTransform.GroutColor.B));
+	}
+}
+
+/**
+ * Returns the group prefix of a wall, which is its tag name without the trailing numbering (ie. "Kitchen_Wall_03" -> "Kitchen_Wall_")
+ * @param MyWall Wall whose group prefix is requested
+ * @return The group prefix, empty if the wall has no name tag
+ */
+FString AMyController::GetWallGroupPrefix(const AMyActor* MyWall) {
+	if (!MyWall || !MyWall->Tags.IsValidIndex(1)) {
+		return FString();
+	}
+	FString Prefix = MyWall->Tags[1].ToString();
+	int32 PrefixLength = Prefix.Len();
+	while (PrefixLength > 0 && FChar::IsDigit(Prefix[PrefixLength - 1])) {
+		PrefixLength--;
+	}
+	Prefix.LeftInline(PrefixLength);
+	return Prefix;
+}
+
+/**
+ * Updates all the selected walls with the selected material in a single pass
  * @param DynamicMaterial Dynamic material to set on the static mesh
  */
 void AMyController::SetWallMaterial(UMaterialInstanceDynamic* DynamicMaterial) const {
-	if (UStaticMeshComponent* StaticMeshComponent = GetSelectedWallStaticMeshComponent()) {
-		StaticMeshComponent->SetMaterial(M_MAT_NUM, DynamicMaterial);
+	bool bApplied = false;
+	for (const AMyActor* MyWall : SelectedWalls) {
+		// Skip walls that already display the material so their render state is not dirtied for nothing
+		if (MyWall && MyWall->StaticMesh->GetMaterial(M_MAT_NUM) != DynamicMaterial) {
+			MyWall->StaticMesh->SetMaterial(M_MAT_NUM, DynamicMaterial);
+			bApplied = true;
+		}
 	}
+	FMyLatencyTracker::MarkMaterialSet(bApplied);
 }
 
 /**
  * Sets the currently selected wall and updates the UI to display the tag name
  * @param MyWallActor Wall that has been clicked on
+ * @param bAdditive When true the wall is toggled in the current selection instead of replacing it (shift-click)
  */
-void AMyController::UpdateSelectedWall(AMyActor* MyWallActor) {
-	if (UStaticMeshComponent* StaticMeshComponent = GetSelectedWallStaticMeshComponent()) {
-		StaticMeshComponent->SetRenderCustomDepth(false);
+void AMyController::UpdateSelectedWall(AMyActor* MyWallActor, const bool bAdditive) {
+	if (!MyWallActor || !MyWallActor->Tags.IsValidIndex(1)) {
+		return;
+	}
+
+	if (bAdditive) {
+		if (SelectedWalls.Remove(MyWallActor) > 0) {
+			SetWallHighlighted(MyWallActor, false);
+		} else {
+			SelectedWalls.Add(MyWallActor);
+			SetWallHighlighted(MyWallActor, true);
+		}
+	} else {
+		ClearSelectedWalls();
+		SelectedWalls.Add(MyWallActor);
+		SetWallHighlighted(MyWallActor, true);
+	}
+	MyReferenceManager->MyHUD->UpdateSelectedWallText(SelectedWalls.Array());
+}
+
+/**
+ * Selects every wall whose location projects inside the screen-space box drawn by the user
+ * @param BoxStart Viewport position where the drag started
+ * @param BoxEnd Viewport position where the drag ended
+ * @param bAdditive When true the walls are added to the current selection instead of replacing it
+ */
+void AMyController::SelectWallsInScreenBox(const FVector2D& BoxStart, const FVector2D& BoxEnd, const bool bAdditive) {
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController) {
+		return;
+	}
+	
+	if (!bAdditive) {
+		ClearSelectedWalls();
+	}
+
+	const FBox2D ScreenBox(FVector2D::Min(BoxStart, BoxEnd), FVector2D::Max(BoxStart, BoxEnd));
+	for (AActor* WallActor : MyWalls) {
+		AMyActor* MyWall = Cast<AMyActor>(WallActor);
+		if (!MyWall || !MyWall->Tags.IsValidIndex(1)) {
+			continue;
+		}
+		FVector2D ScreenPosition;
+		if (PlayerController->ProjectWorldLocationToScreen(MyWall->StaticMesh->Bounds.Origin, ScreenPosition)
+			&& ScreenBox.IsInside(ScreenPosition)) {
+			bool bAlreadySelected = false;
+			SelectedWalls.Add(MyWall, &bAlreadySelected);
+			if (!bAlreadySelected) {
+				SetWallHighlighted(MyWall, true);
+			}
+		}
+	}
+	MyReferenceManager->MyHUD->UpdateSelectedWallText(SelectedWalls.Array());
+}
+
+/**
+ * Selects every wall of a group, whose tag name is the given prefix followed by its numbering only, so "Wall_" does not
+ * select "Wall_Panel3"
+ * @param TagPrefix Group prefix of the walls, see GetWallGroupPrefix() (ie. "Kitchen_Wall_")
+ * @param bAdditive When true the walls are added to the current selection instead of replacing it
+ */
+void AMyController::SelectWallsByTagPrefix(const FString& TagPrefix, const bool bAdditive) {
+	if (!bAdditive) {
+		ClearSelectedWalls();
 	}
 	
-	if (MyWallActor) {
-		SelectedWall = MyWallActor;
-		if (MyWallActor && !MyWallActor->Tags.IsEmpty() && MyWallActor->Tags.IsValidIndex(1)) {
-			MyReferenceManager->MyHUD->UpdateSelectedWallText(MyWallActor);
-			if (UStaticMeshComponent* StaticMeshComponent = GetSelectedWallStaticMeshComponent()) {
-				StaticMeshComponent->SetRenderCustomDepth(true);
+	for (AActor* WallActor : MyWalls) {
+		AMyActor* MyWall = Cast<AMyActor>(WallActor);
+		if (MyWall && GetWallGroupPrefix(MyWall) == TagPrefix) {
+			bool bAlreadySelected = false;
+			SelectedWalls.Add(MyWall, &bAlreadySelected);
+			if (!bAlreadySelected) {
+				SetWallHighlighted(MyWall, true);
 			}
 		}
 	}
+	MyReferenceManager->MyHUD->UpdateSelectedWallText(SelectedWalls.Array());
+}
+
+/**
+ * Extends the current selection to every wall sharing a group prefix with an already selected wall
+ */
+void AMyController::SelectGroupOfSelectedWalls() {
+	TSet<FString> GroupPrefixes;
+	for (const AMyActor* MyWall : SelectedWalls) {
+		const FString GroupPrefix = GetWallGroupPrefix(MyWall);
+		if (!GroupPrefix.IsEmpty()) {
+			GroupPrefixes.Add(GroupPrefix);
+		}
+	}
+	
+	for (const FString& GroupPrefix : GroupPrefixes) {
+		SelectWallsByTagPrefix(GroupPrefix, true);
+	}
+}
+
+/**
+ * Removes the highlight from every selected wall and empties the selection
+ */
+void AMyController::ClearSelectedWalls() {
+	for (const AMyActor* MyWall : SelectedWalls) {
+		SetWallHighlighted(MyWall, false);
+	}
+	SelectedWalls.Reset();
 }
 
 /**
- * Updates the selected wall with its default material
+ * Updates all the selected walls with their default material
  */
 void AMyController::SetDefaultMaterial() const {
-	if (UStaticMeshComponent* StaticMeshComponent = GetSelectedWallStaticMeshComponent()) {
-		StaticMeshComponent->SetMaterial(M_MAT_NUM, SelectedWall->MaterialInterface);
+	bool bApplied = false;
+	for (const AMyActor* MyWall : SelectedWalls) {
+		if (MyWall && MyWall->StaticMesh->GetMaterial(M_MAT_NUM) != MyWall->MaterialInterface) {
+			MyWall->StaticMesh->SetMaterial(M_MAT_NUM, MyWall->MaterialInterface);
+			bApplied = true;
+		}
 	}
+	FMyLatencyTracker::MarkMaterialSet(bApplied);
 }
 
 /**
  * Saves the specified information from the game
  */
 void AMyController::SaveGame() {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_SaveGame);
 	UMySaveGame* MySaveGame = Cast<UMySaveGame>(UGameplayStatics::CreateSaveGameObject(UMySaveGame::StaticClass()));
+	// Tiles are saved by CleanName, which differs from the file name of a tile whose name is taken in another root
+	TMap<const UMaterialInterface*, const FMyDynamicMat*> MaterialTiles;
+	for (const FMyDynamicMat& DynamicMat : DynamicMaterialArray) {
+		if (DynamicMat.DynamicMaterial) {
+			MaterialTiles.Add(DynamicMat.DynamicMaterial, &DynamicMat);
+		}
+	}
 	for (AActor* Element : MyWalls) {
 		// Get Wall
 		AMyActor* Wall = Cast<AMyActor>(Element);
 		// Get texture name used in this wall
 		const UMaterialInterface* WallMaterialInterface = Wall->StaticMesh->GetMaterial(M_MAT_NUM);
-		TArray<UTexture*> UsedTextures;
-		WallMaterialInterface->GetUsedTextures(UsedTextures, EMaterialQualityLevel::Num, true, ERHIFeatureLevel::SM5, true);
-		FString CleanTextureSourceFileName = FPaths::GetCleanFilename(UsedTextures[0]->AssetImportData->GetFirstFilename());
+		const FMyDynamicMat* WallTile = MaterialTiles.FindRef(WallMaterialInterface);
+		FString CleanTextureSourceFileName;
+		if (WallTile) {
+			CleanTextureSourceFileName = WallTile->CleanName.ToString();
+		} else {
+			TArray<UTexture*> UsedTextures;
+			WallMaterialInterface->GetUsedTextures(UsedTextures, EMaterialQualityLevel::Num, true, ERHIFeatureLevel::SM5, true);
+			// The maps of a tile set are not named, only its albedo is
+			for (const UTexture* UsedTexture : UsedTextures) {
+				if (UsedTexture && UsedTexture->AssetImportData && !UsedTexture->AssetImportData->GetFirstFilename().IsEmpty()) {
+					CleanTextureSourceFileName = FPaths::GetCleanFilename(UsedTexture->AssetImportData->GetFirstFilename());
+					break;
+				}
+			}
+		}
 		// Create new Map pair
 		TPair<AMyActor*, FString> Pair;
 		Pair.Key = Wall;
 		Pair.Value = CleanTextureSourceFileName;
 		
 		MySaveGame->SaveMap.Add(Pair);
+		if (const FMyDynamicMat* DynamicMat = WallTile ? WallTile : FindDynamicMaterial(FName(*CleanTextureSourceFileName))) {
+			MySaveGame->ContentHashes.Add(CleanTextureSourceFileName, DynamicMat->ContentHash);
+		}
 	}
+	MySaveGame->TileTransforms = WallTileTransforms;
 	
 	UGameplayStatics::SaveGameToSlot(MySaveGame, M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM);
-	const FDataTableContent* DataTableContent = MessageDataTable->FindRow<FDataTableContent>(MessageDataTableRowNames[FileSavedOK], "", true);
-	MyReferenceManager->MyHUD->Notify(Info, DataTableContent->Message);
+	MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FileSavedOK), M_NOTIFY_CATEGORY_SAVE_GAME);
 }
 
 /**
- * Load the specified information from the game
+ * Load the specified information from the game. During a library mount the save is loaded once the mount is finished,
+ * as its tiles would be looked for in a partial catalog and the walls reset or remapped to the wrong tiles
  */
 void AMyController::LoadGame() {
+	if (LibraryMount) {
+		UE_LOG(LogTemp, Display, TEXT("Loading the save once the library is mounted"));
+		bLoadGamePending = true;
+		return;
+	}
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_LoadGame);
 	if (UGameplayStatics::DoesSaveGameExist(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM)) {
 		const UMySaveGame* MySaveGame = Cast<UMySaveGame>(UGameplayStatics::LoadGameFromSlot(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM));
 		SaveMap = MySaveGame->SaveMap;
-		if (RenderSaveMap()) {
-			MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FileLoadedOK));
+		SavedContentHashes = MySaveGame->ContentHashes;
+		WallTileTransforms = MySaveGame->TileTransforms;
+		for (AActor* WallActor : MyWalls) {
+			const AMyActor* MyWall = Cast<AMyActor>(WallActor);
+			ApplyTileTransform(MyWall, GetTileTransform(MyWall));
 		}
+		RenderSaveMap([this]() {
+			MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FileLoadedOK), M_NOTIFY_CATEGORY_SAVE_GAME);
+		});
 	} else {
-		MyReferenceManager->MyHUD->Notify(Error, RetrieveDataTableMessage(FileLoadedKO404));
+		MyReferenceManager->MyHUD->Notify(Error, RetrieveDataTableMessage(FileLoadedKO404), M_NOTIFY_CATEGORY_SAVE_GAME);
 	}
 }
 
 /**
- * Iterates over the TMap save file to assign materials to walls, if the material's source file exist.
+ * Iterates over the TMap save file to assign materials to walls. Textures missing from the library are remapped to the
+ * tile with the same content first, then to the tile with the closest name. The tiles are resolved at once, while
+ * loading them and setting the wall materials is left to the frame scheduler, ahead of any other work. Walls that
+ * could not be remapped are listed to the user, along with the walls remapped by name for the user to confirm, as a
+ * close name may as well be another variant of the tile (ie. "tile_07" and "tile_08")
+ * @param OnRendered Called once every wall shows its tile, unless some walls could not be remapped
+ * @return False if some walls could not be remapped
  */
-bool AMyController::RenderSaveMap() {
+bool AMyController::RenderSaveMap(TUniqueFunction<void()>&& OnRendered) {
 	TMap<FString, FString> MissingFiles;
-	for (const TPair<AMyActor*, FString>& SaveMapEntry : SaveMap) {
+	TMap<FString, const FMyDynamicMat*> Replacements;
+	// Textures remapped by name to the name of their tile, and the walls using them
+	TMap<FString, FString> NameReplacements;
+	TMap<FString, FString> NameRemappedFiles;
+	int32 RemappedCount = 0;
+	UMyFrameScheduler* Scheduler = UMyFrameScheduler::Get(this);
+	
+	// Walls left to render, plus one released by the last work item so OnRendered cannot run before it
+	struct FMySaveMapRender {
+		int32 PendingWalls = 1;
+		TUniqueFunction<void()> OnRendered;
+	};
+	const TSharedRef<FMySaveMapRender> Render = MakeShared<FMySaveMapRender>();
+	Render->OnRendered = MoveTemp(OnRendered);
+	const auto WallRendered = [Render]() {
+		if (--Render->PendingWalls == 0 && Render->OnRendered) {
+			Render->OnRendered();
+		}
+	};
+	
+	for (TPair<AMyActor*, FString>& SaveMapEntry : SaveMap) {
+		AMyActor* Wall = SaveMapEntry.Key;
 		// Check if the wall material is the default base material
 		if (SaveMapEntry.Value == M_BASE_TEXTURE_NAME) {
-			SaveMapEntry.Key->StaticMesh->SetMaterial(M_MAT_NUM, SaveMapEntry.Key->MaterialInterface);
+			Wall->StaticMesh->SetMaterial(M_MAT_NUM, Wall->MaterialInterface);
 			continue;
 		}
 
-		// Id the wall's material exists, look for it in the DynamicMaterialArray and set it 
-		if (FPaths::FileExists(ResourcesDirPath + SaveMapEntry.Value)) {
-			for (FMyDynamicMat DynamicMat : DynamicMaterialArray) {
-				if (DynamicMat.CleanName == SaveMapEntry.Value) {
-					SaveMapEntry.Key->StaticMesh->SetMaterial(M_MAT_NUM, DynamicMat.DynamicMaterial);
-					break;
+		// If the wall's material is in the DynamicMaterialArray set it, otherwise look for a replacement once per file
+		const FMyDynamicMat* DynamicMat = FindDynamicMaterial(FName(*SaveMapEntry.Value));
+		if (!DynamicMat) {
+			const FMyDynamicMat** Replacement = Replacements.Find(SaveMapEntry.Value);
+			if (!Replacement) {
+				bool bByName;
+				Replacement = &Replacements.Add(SaveMapEntry.Value, FindReplacementTile(SaveMapEntry.Value, bByName));
+				if (*Replacement && bByName) {
+					NameReplacements.Add(SaveMapEntry.Value, (*Replacement)->CleanName.ToString());
 				}
 			}
-		}else {
-			TPair<FString, FString> Pair;
-			Pair.Key = SaveMapEntry.Key->Tags[1].ToString();
-			Pair.Value = SaveMapEntry.Value;
-			
-			MissingFiles.Add(Pair);
-			SaveMapEntry.Key->StaticMesh->SetMaterial(M_MAT_NUM, SaveMapEntry.Key->MaterialInterface);
+			DynamicMat = *Replacement;
+			if (DynamicMat) {
+				if (NameReplacements.Contains(SaveMapEntry.Value)) {
+					NameRemappedFiles.Add(Wall->Tags[1].ToString(), SaveMapEntry.Value);
+				}
+				SaveMapEntry.Value = DynamicMat->CleanName.ToString();
+				RemappedCount++;
+			}
 		}
-	}
-	if (!MissingFiles.IsEmpty()) {
-		for (auto MissingFile : MissingFiles) {
-			UE_LOG(LogTemp, Warning, TEXT("Missing the following texture: %s"), *MissingFile.Value)
+		if (!DynamicMat) {
+			MissingFiles.Add(Wall->Tags[1].ToString(), SaveMapEntry.Value);
+			Wall->StaticMesh->SetMaterial(M_MAT_NUM, Wall->MaterialInterface);
+			continue;
 		}
 		
-		MyReferenceManager->MyHUD->DisplayMissingFilesDialog(MissingFiles);
+		Render->PendingWalls++;
+		Scheduler->Submit(this, EMyWorkPriority::High, [this, WeakWall = TWeakObjectPtr<AMyActor>(Wall), TileName = DynamicMat->CleanName, WallRendered]() {
+			LoadDynamicMaterial(TileName, [WeakWall, WallRendered](const FMyDynamicMat* Tile) {
+				if (AMyActor* LoadedWall = WeakWall.Get()) {
+					LoadedWall->StaticMesh->SetMaterial(M_MAT_NUM, Tile ? Tile->DynamicMaterial : LoadedWall->MaterialInterface);
+				}
+				WallRendered();
+			});
+		});
+	}
+	Scheduler->Submit(this, EMyWorkPriority::High, [WallRendered]() {
+		WallRendered();
+	});
+	
+	if (RemappedCount > 0) {
+		for (const TPair<FString, const FMyDynamicMat*>& Replacement : Replacements) {
+			if (Replacement.Value) {
+				UE_LOG(LogTemp, Display, TEXT("Remapped missing texture %s to %s"), *Replacement.Key, *Replacement.Value->CleanName.ToString());
+			}
+		}
+		MyReferenceManager->MyHUD->Notify(Info, FText::Format(RetrieveDataTableMessage(TexturesRemapped), RemappedCount));
+	}
+	
+	for (auto MissingFile : MissingFiles) {
+		UE_LOG(LogTemp, Warning, TEXT("Missing the following texture: %s"), *MissingFile.Value)
+	}
+	if (!MissingFiles.IsEmpty() || !NameRemappedFiles.IsEmpty()) {
+		TMap<FString, FString> ListedFiles = MissingFiles;
+		ListedFiles.Append(NameRemappedFiles);
+		MyReferenceManager->MyHUD->DisplayMissingFilesDialog(ListedFiles, NameReplacements);
+	}
+	if (!MissingFiles.IsEmpty()) {
+		Render->OnRendered = nullptr;
 		return false;
 	}
 	return true;
 }
 
+/**
+ * Looks for the tile a missing texture has most likely become: the tile with the same content hash as recorded in the
+ * save file, otherwise the tile with the closest name
+ * @param MissingFile Clean file name of the missing texture
+ * @param bOutByName Set to whether the tile has been found by name, which is only a guess the user has to confirm
+ * @return The replacement tile, nullptr if none has been found
+ */
+const FMyDynamicMat* AMyController::FindReplacementTile(const FString& MissingFile, bool& bOutByName) const {
+	bOutByName = false;
+	if (const uint64* ContentHash = SavedContentHashes.Find(MissingFile)) {
+		if (const int32* Index = ContentHashIndices.Find(*ContentHash)) {
+			return &DynamicMaterialArray[*Index];
+		}
+	}
+	
+	bOutByName = true;
+	const int32 TileId = TileNameIndex.FindClosest(MissingFile);
+	const int32* Index = TileIdIndices.Find(TileId);
+	return Index ? &DynamicMaterialArray[*Index] : nullptr;
+}
+
+/**
+ * Looks for the tile an image file belongs to, as its albedo or as one of the maps of its tile set
+ * @param FilePath Full path of the file
+ * @return The tile, nullptr if the file is not part of the DynamicMaterialArray
+ */
+const FMyDynamicMat* AMyController::FindTileByFile(const FString& FilePath) const {
+	const int32* Index = FileIndices.Find(FilePath);
+	return Index ? &DynamicMaterialArray[*Index] : nullptr;
+}
+
 /**
  * Deletes the save file
  */
 void AMyController::DeleteSaveFile() {
 	if (UGameplayStatics::DoesSaveGameExist(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM)) {
 		if (UGameplayStatics::DeleteGameInSlot(M_SAVE_SLOT_NAME, M_SAVE_SLOT_NUM)) {
-			MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FileDeletedOK));
+			MyReferenceManager->MyHUD->Notify(Info, RetrieveDataTableMessage(FileDeletedOK), M_NOTIFY_CATEGORY_SAVE_GAME);
 		} else {
-			MyReferenceManager->MyHUD->Notify(Error, RetrieveDataTableMessage(FileDeletedKO));
+			MyReferenceManager->MyHUD->Notify(Error, RetrieveDataTableMessage(FileDeletedKO), M_NOTIFY_CATEGORY_SAVE_GAME);
 		}
 	}
 }
 
 /**
- * Handles any click on the screen to clear the selected wall label and remove the wall's outline
+ * Handles any click on the screen to clear the selected walls label and remove the walls' outline, unless shift is held
+ * @param bAdditive Whether shift was held, passed in rather than read so recorded clicks replay the same
  */
-void AMyController::ScreenClicked() {
-	if (!WallHovered) {
-		if (UStaticMeshComponent* StaticMeshComponent = GetSelectedWallStaticMeshComponent()) {
-			StaticMeshComponent->SetRenderCustomDepth(false);
-			MyReferenceManager->MyHUD->UpdateSelectedWallText(nullptr);
+void AMyController::ScreenClicked(const bool bAdditive) {
+	if (!WallHovered && !bAdditive) {
+		if (!SelectedWalls.IsEmpty()) {
+			ClearSelectedWalls();
+			MyReferenceManager->MyHUD->UpdateSelectedWallText(TArray<AMyActor*>());
 		}
-		SelectedWall = nullptr;
 	} 
 }
 
@@ -343,61 +1799,43 @@ void AMyController::ScreenClicked() {
  * @param ScreenshotName Name of the screenshot provided by the user via the UI
  */
 void AMyController::CreateScreenshot(const FText& ScreenshotName) const {
-	if (UStaticMeshComponent* StaticMeshComponent = GetSelectedWallStaticMeshComponent()) {
-		StaticMeshComponent->SetRenderCustomDepth(false);
-		MyReferenceManager->MyHUD->UpdateSelectedWallText(nullptr);
-	}
-	// Store screenshot in Project directory next to main UProject/EXE based on the build type
-	#if WITH_EDITOR
-		const FString ImageDirectory = FString::Printf(TEXT("%s/%s"), *FPaths::ProjectDir(), TEXT("Screenshots"));
-	#else
-		const FString ImageDirectory = FString::Printf(TEXT("%s/../%s"), *FPaths::ProjectDir(), TEXT("Screenshots"));
-	#endif
-	ScreenshotFilename = FString::Printf(TEXT("%s/%s.png"), *ImageDirectory, *ScreenshotName.ToString());
-	FScreenshotRequest::RequestScreenshot(ScreenshotFilename, false, false);
-	
-	UGameViewportClient::OnScreenshotCaptured().AddStatic(&ScreenshotCaptured);
+	if (!SelectedWalls.IsEmpty()) {
+		for (const AMyActor* MyWall : SelectedWalls) {
+			SetWallHighlighted(MyWall, false);
+		}
+		MyReferenceManager->MyHUD->UpdateSelectedWallText(TArray<AMyActor*>());
+	}
+	ScreenshotService->RequestScreenshot(ScreenshotName.ToString(), ScreenshotEncodeSettings);
 }
 
 /**
- * Called via delegate once the request to create a screenshot has been carried out
- * @param Width Screenshot width
- * @param Height Screenshot height
- * @param Bitmap Array of bits that specify the color of each pixel in a rectangular array of pixels
+ * Called by the screenshot service once the downscaled preview of a captured screenshot is ready
+ * @param RequestId Identifier returned when the screenshot was requested
+ * @param PreviewTexture Texture displaying the screenshot preview
  */
-void AMyController::ScreenshotCaptured(int32 Width, int32 Height, const TArray<FColor>& Bitmap) {
-	// Create .png from Bitmap
-	TArray64<uint8> ImageData;
-	TArray BitmapCopy(Bitmap);
-	FImageUtils::PNGCompressImageArray(Width, Height, BitmapCopy, ImageData);
-	FFileHelper::SaveArrayToFile(ImageData, *ScreenshotFilename);
-
-	// Create Texture2D from Bitmap
-	UTexture2D* Texture = UTexture2D::CreateTransient(Width, Height);
-	if (Texture) {
-		Texture->CompressionSettings = TC_Displacementmap;
-		Texture->SRGB = 0;
-
-		FTexture2DMipMap& MipMap = Texture->GetPlatformData()->Mips[0];
-
-		void* Data = MipMap.BulkData.Lock(LOCK_READ_WRITE);
-
-		constexpr int32 Stride = sizeof(uint8) * 4;
-		FMemory::Memcpy(Data, Bitmap.GetData(), Texture->GetPlatformData()->SizeX * Texture->GetPlatformData()->SizeY * Stride);
-		MipMap.BulkData.Unlock();
-		
-		Texture->UpdateResource();
-		MyReferenceManager->MyHUD->TriggerScreenshotEffect(Texture);
+void AMyController::ScreenshotPreviewReady(int32 RequestId, UTexture2D* PreviewTexture) {
+	if (PreviewTexture) {
+		MyReferenceManager->MyHUD->TriggerScreenshotEffect(PreviewTexture);
 	}
 }
 
+/**
+ * Called by the screenshot service once a requested screenshot has been written in the background
+ * @param RequestId Identifier returned when the screenshot was requested
+ * @param Filename Path the screenshot was written to
+ * @param bSaved Whether the screenshot could be written
+ */
+void AMyController::ScreenshotSaved(int32 RequestId, const FString& Filename, const bool bSaved) {
+	MyReferenceManager->MyHUD->ScreenshotSaved(Filename, bSaved);
+}
+
 /**
  * Returns the message from MessageDataTable belonging to the DataTableContentIndex used
  * @param DataTableContentIndex EDataTableContentIndex numerical index used to indicate a MessageDataTable row
- * @return The MessageDataTable row's message
+ * @return The MessageDataTable row's message, empty if the table has no such row
  */
 FText AMyController::RetrieveDataTableMessage(const EDataTableContentIndex DataTableContentIndex) {
-	return MessageDataTable->FindRow<FDataTableContent>(MessageDataTableRowNames[DataTableContentIndex], "", true)->Message;
+	return MessageCatalog.Get(DataTableContentIndex);
 }
 
 bool AMyController::IsTileSelectEnabled() {
@@ -4,12 +4,21 @@
 
 #include "CoreMinimal.h"
 #include "IDirectoryWatcher.h"
+#include "ImageCore.h"
+#include "Containers/Ticker.h"
+#include "Tasks/Task.h"
 #include "MDVProject4/Utils/DataStructures.h"
+#include "MDVProject4/Utils/MyMessageCatalog.h"
+#include "MDVProject4/Utils/TileDuplicateIndex.h"
+#include "MDVProject4/Utils/TileNameIndex.h"
+#include "MDVProject4/Utils/TileSetNaming.h"
 #include "AMyController.generated.h"
 
 class AMyActor;
 class AMyReferenceManager;
 class AMyHUD;
+class UMyScreenshotService;
+class FMyTilePack;
 
 
 UCLASS()
@@ -21,6 +30,10 @@ class MDVPROJECT4_API AMyController : public AActor {
 DECLARE_DELEGATE_RetVal(AMyController, Delegate);
 
 	GENERATED_BODY()
+
+	friend class FMyBenchmark;
+	friend class FMyInputRecorder;
+	friend class UMyTilePackCommandlet;
 	
 public:
 	explicit AMyController();
@@ -29,7 +42,19 @@ public:
 
 	void SetDefaultMaterial() const;
 
-	void UpdateSelectedWall(AMyActor* MyWallActor);
+	void UpdateSelectedWall(AMyActor* MyWallActor, bool bAdditive = false);
+
+	void SelectWallsInScreenBox(const FVector2D& BoxStart, const FVector2D& BoxEnd, bool bAdditive);
+
+	void SelectWallsByTagPrefix(const FString& TagPrefix, bool bAdditive);
+
+	void SelectGroupOfSelectedWalls();
+
+	void ClearSelectedWalls();
+
+	void SetTileTransform(const FMyTileTransform& TileTransform);
+
+	FMyTileTransform GetTileTransform(const AMyActor* MyWall) const;
 
 	void SaveGame();
 	void LoadGame();
@@ -39,28 +64,69 @@ public:
 	
 	FText RetrieveDataTableMessage(EDataTableContentIndex DataTableContentIndex);
 
+	const FMyDynamicMat* FindDynamicMaterial(FName CleanName) const;
+
+	// Called on the game thread once a tile is loaded, with nullptr if it could not be
+	using FMyOnTileLoaded = TUniqueFunction<void(const FMyDynamicMat* DynamicMat)>;
+
+	void LoadDynamicMaterial(FName CleanName, FMyOnTileLoaded&& OnLoaded);
+
+	void LoadTile(int32 TileId, FMyOnTileLoaded&& OnLoaded = nullptr);
+
+	void RemapWalls(const TArray<FString>& WallNames, FName TileName);
+
+	void SearchTiles(const FString& Query, TArray<int32>& OutTileIds) const;
+
+	void RankTilesByColor(const FLinearColor& Color, TArray<int32>& OutTileIds) const;
+
 static bool IsTileSelectEnabled();
 
-	static void ScreenshotCaptured(int32 Width, int32 Height, const TArray<FColor>& Bitmap);
-	
-	void ScreenClicked();
+	void ScreenClicked(bool bAdditive);
 
+	UPROPERTY()
 	TArray<FMyDynamicMat> DynamicMaterialArray;
 
 	bool WallHovered;
 	
-	FString ResourcesDirPath;
+	// Directories the tile library is made of, full paths ending with a slash
+	TArray<FString> LibraryRoots;
+
+	void MountLibraryRoots(const TArray<FString>& Roots);
+
+	bool IsMountingLibrary() const { return LibraryMount.IsValid(); }
+
+	static FString NormaliseLibraryRoot(const FString& Root);
 
 protected:
-	void CreateDirectoryWatcherDelegate();
+	void RegisterDirectoryWatchers();
+
+	void UnregisterDirectoryWatchers();
 	
 	virtual void BeginPlay() override;
 
-	UStaticMeshComponent* GetSelectedWallStaticMeshComponent() const;
+	virtual void PostInitializeComponents() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void WallRegistered(AMyActor* MyWall);
+
+	void WallUnregistered(AMyActor* MyWall);
+
+	void GatherVisibleMaterials(TSet<const UMaterialInterface*>& VisibleMaterials) const;
+
+	void SetWallHighlighted(const AMyActor* MyWall, bool bHighlighted) const;
+
+	static void ApplyTileTransform(const AMyActor* MyWall, const FMyTileTransform& TileTransform);
+
+	static FString GetWallGroupPrefix(const AMyActor* MyWall);
 	
 	void InitialiseDynamicMaterialArray();
 	
-	void InsertItemToDynamicMaterialArray(const FString& FilePath);
+	void InsertItemToDynamicMaterialArray(const FMyTileSetFiles& TileSet);
+
+	void InsertItemsToDynamicMaterialArray(const TArray<FMyTileSetFiles>& TileSets);
+
+	void RemoveItemFromDynamicMaterialArray(const FMyDynamicMat& Element);
 	
 	void UpdateDynamicMaterialArray(const FString& FileName, FFileChangeData::EFileChangeAction Action);
 	
@@ -68,11 +134,14 @@ protected:
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall tagging")
 	FName WallsTag;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Screenshots")
+	FScreenshotEncodeSettings ScreenshotEncodeSettings;
 	
 	UPROPERTY()
 	UDataTable* MessageDataTable;
 	
-	TArray<FName> MessageDataTableRowNames;
+	FMyMessageCatalog MessageCatalog;
 	
 private:
 	static inline AMyReferenceManager* MyReferenceManager;
@@ -81,17 +150,205 @@ private:
 	UMaterialInterface* BaseMaterial;
 
 	UPROPERTY()
-	AMyActor* SelectedWall;
+	TSet<AMyActor*> SelectedWalls;
 
 	UPROPERTY()
 	TArray<AActor*> MyWalls;
 
 	UPROPERTY()
 	TMap<AMyActor*, FString> SaveMap;
+
+	// Tile transform of the walls that do not use the default one, by path so a wall streamed back in finds its own
+	UPROPERTY()
+	TMap<TSoftObjectPtr<AMyActor>, FMyTileTransform> WallTileTransforms;
+
+	// Content hashes of the textures used in the loaded save file
+	TMap<FString, uint64> SavedContentHashes;
+
+	// Index of each tile of the DynamicMaterialArray by CleanName, by content hash, and by the path of each of its files.
+	// Identical files share their hash
+	TMap<FName, int32> DynamicMaterialIndices;
+	TMultiMap<uint64, int32> ContentHashIndices;
+	TMap<int32, int32> TileIdIndices;
+	TMap<FString, int32> FileIndices;
+
+	// Search index of the DynamicMaterialArray by TileId, kept up to date as tiles are added and removed
+	FMyTileNameIndex TileNameIndex;
+
+	// Perceptual hashes of the DynamicMaterialArray by TileId, and the TileIds of each group of near-duplicates by
+	// the TileId of its representative
+	FMyTileDuplicateIndex DuplicateIndex;
+	TMap<int32, TArray<int32>> TileGroups;
+
+	int32 NextTileId = 0;
+
+	// The tiles of a catalog and the indices over them, either the live catalog above or the staged catalog of a
+	// library being mounted, for the code that fills both
+	struct FMyCatalogView {
+		TArray<FMyDynamicMat>& DynamicMaterialArray;
+		const TArray<FString>& LibraryRoots;
+		TMap<FName, int32>& DynamicMaterialIndices;
+		TMultiMap<uint64, int32>& ContentHashIndices;
+		TMap<int32, int32>& TileIdIndices;
+		TMap<FString, int32>& FileIndices;
+		FMyTileNameIndex& TileNameIndex;
+		FMyTileDuplicateIndex& DuplicateIndex;
+		TMap<int32, TArray<int32>>& TileGroups;
+	};
+
+	FMyCatalogView GetLiveCatalog();
+
+	FMyCatalogView GetStagedCatalog();
+
+	void RebuildDynamicMaterialIndices();
+
+	void MoveTileIndices(const FMyDynamicMat& DynamicMat, int32 FromIndex, int32 ToIndex);
+
+	void RebuildTileIndices();
+
+	static int32 FindDuplicateGroup(const FMyDynamicMat& DynamicMat, const FMyCatalogView& Catalog);
+
+	static void SetGroupRepresentative(TArray<int32>&& Members, int32 RepresentativeId, const FMyCatalogView& Catalog);
+
+	void GetRepresentatives(TArray<int32>& TileIds) const;
+
+	static TArray<FString> GetTileKeywords(const FString& FilePath, const TArray<FString>& Roots);
+
+	// A tile file read, hashed and decoded off the game thread, waiting for its texture to be created. The maps of a
+	// tile set are decoded along with its albedo
+	struct FMyDecodedTile {
+		FString FilePath;
+		FString NormalPath;
+		FString RoughnessPath;
+		uint64 ContentHash = 0;
+		FImage Image;
+		FImage NormalImage;
+		FImage RoughnessImage;
+		// Shrunk copy of Image, shown until Image has been uploaded. Empty for a small image
+		FImage PreviewImage;
+		FMyColorSignature ColorSignature;
+		uint64 PerceptualHash = 0;
+		int64 PixelCount = 0;
+		// Entry of the tile in TilePack, INDEX_NONE for a loose file
+		TSharedPtr<FMyTilePack> TilePack;
+		int32 PackEntry = INDEX_NONE;
+		bool bDecoded = false;
+	};
+
+	static void DecodeTile(FMyDecodedTile& DecodedTile);
+
+	void AddDecodedTile(FMyDecodedTile& DecodedTile, const FMyCatalogView& Catalog);
+
+	static FName MakeUniqueTileName(const FString& FilePath, const FMyCatalogView& Catalog);
+
+	bool CreateTileMaterial(FMyDynamicMat& DynamicMat, FMyDecodedTile& DecodedTile);
+
+	// Requests waiting for the tiles being loaded by LoadTile(), by TileId
+	TMap<int32, TArray<FMyOnTileLoaded>> TileLoads;
+
+	void FinishTileLoad(int32 TileId, FMyDecodedTile& DecodedTile);
+
+	// Textures of a tile left to the texture uploader by CreateTileMaterial()
+	struct FMyTileUpload {
+		int32 TileId = INDEX_NONE;
+		// Material the textures are bound to, with what creates them, as a wall may keep it after the tile left the catalog
+		TWeakObjectPtr<UMaterialInstanceDynamic> DynamicMaterial;
+		FString Path;
+		TSharedPtr<FMyTilePack> TilePack;
+		int32 PackEntry = INDEX_NONE;
+		// Whether the albedo is a preview, to be replaced by the pack's full mip chain or by Image
+		bool bFullTexture = false;
+		FImage Image;
+		FImage NormalImage;
+		FImage RoughnessImage;
+	};
+
+	void UploadTileTextures(FMyTileUpload& Upload);
+
+	TSet<const UMaterialInterface*> GetWallMaterials() const;
+
+	void ReleaseTileMaterial(const FMyDynamicMat& DynamicMat, const TSet<const UMaterialInterface*>& WallMaterials) const;
+
+	static TArray<FMyDecodedTile> DecodeTiles(const TArray<FMyTileSetFiles>& TileSets);
+
+	// Tiles of library roots: those that can be created from packs, and the tile sets whose files must be decoded
+	struct FMyLibraryScan {
+		TArray<FMyDecodedTile> PackedTiles;
+		TArray<FMyTileSetFiles> LooseSets;
+	};
+
+	static FMyLibraryScan ScanLibraryRoots(const TArray<FString>& Roots);
+
+	// Watcher registered on each library root
+	TMap<FString, FDelegateHandle> WatcherHandles;
+
+	// Library being mounted by MountLibraryRoots(): scanned and decoded by tasks, its tiles created a few per frame
+	struct FMyLibraryMount {
+		TArray<FString> Roots;
+		UE::Tasks::TTask<FMyLibraryScan> ScanTask;
+		UE::Tasks::TTask<TArray<FMyDecodedTile>> DecodeTask;
+		bool bScanned = false;
+		bool bDecoding = false;
+		// Decoded tiles submitted to the frame scheduler and not added to the staged catalog yet
+		int32 ScheduledTiles = 0;
+		TArray<FMyTileSetFiles> PendingSets;
+	};
+
+	TUniquePtr<FMyLibraryMount> LibraryMount;
+
+	FTSTicker::FDelegateHandle LibraryMountTickerHandle;
+
+	// Changes with every mount and cancellation, so tiles scheduled for a previous mount are dropped
+	uint32 LibraryMountGeneration = 0;
+
+	// Whether LoadGame() was called during a mount, it runs once the mounted library is swapped in
+	bool bLoadGamePending = false;
+
+	// Catalog of the library being mounted, swapped with the live one while tiles are added to it and once complete
+	UPROPERTY()
+	TArray<FMyDynamicMat> StagedDynamicMaterialArray;
+
+	struct FMyStagedCatalog {
+		TArray<FString> LibraryRoots;
+		TMap<FName, int32> DynamicMaterialIndices;
+		TMultiMap<uint64, int32> ContentHashIndices;
+		TMap<int32, int32> TileIdIndices;
+		TMap<FString, int32> FileIndices;
+		FMyTileNameIndex TileNameIndex;
+		FMyTileDuplicateIndex DuplicateIndex;
+		TMap<int32, TArray<int32>> TileGroups;
+	};
+
+	FMyStagedCatalog StagedCatalog;
+
+	void SwapStagedCatalog();
+
+	bool TickLibraryMount(float DeltaTime);
+
+	void ScheduleMountedTiles(TArray<FMyDecodedTile>&& DecodedTiles);
+
+	void FinishLibraryMount();
+
+	void CancelLibraryMount();
+
+	// Tiles of a replaced library or of a cancelled mount, waiting to be released by the frame scheduler
+	UPROPERTY()
+	TArray<FMyDynamicMat> RetiredDynamicMaterialArray;
+
+	void RetireTiles(TArray<FMyDynamicMat>&& Tiles);
+
+	void ReleaseRetiredTiles();
 	
-	bool RenderSaveMap();
+	bool RenderSaveMap(TUniqueFunction<void()>&& OnRendered);
+
+	const FMyDynamicMat* FindReplacementTile(const FString& MissingFile, bool& bOutByName) const;
+
+	const FMyDynamicMat* FindTileByFile(const FString& FilePath) const;
 
-	FDelegateHandle ScreenshotDelegateHandle;
+	void ScreenshotPreviewReady(int32 RequestId, UTexture2D* PreviewTexture);
 
-	static inline FString ScreenshotFilename;
+	void ScreenshotSaved(int32 RequestId, const FString& Filename, bool bSaved);
+
+	UPROPERTY()
+	UMyScreenshotService* ScreenshotService;
 };
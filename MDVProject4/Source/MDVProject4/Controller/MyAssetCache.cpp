@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyAssetCache.h"
+
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Kismet/GameplayStatics.h"
+
+
+/**
+ * Returns the cache of the running game instance
+ * @param WorldContextObject Any object of a game world
+ * @return The cache, nullptr outside of a game instance (ie. editor worlds)
+ */
+UMyAssetCache* UMyAssetCache::Get(const UObject* WorldContextObject) {
+	const UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UMyAssetCache>() : nullptr;
+}
+
+/**
+ * Starts loading the shared asset bundle in the background
+ */
+void UMyAssetCache::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+	
+	HorizontalStrippedOverlayMat = TSoftObjectPtr<UMaterialInterface>(FSoftObjectPath(TEXT("/Game/Materials/MI_StrippedHorizontal.MI_StrippedHorizontal")));
+	VerticalStrippedOverlayMat = TSoftObjectPtr<UMaterialInterface>(FSoftObjectPath(TEXT("/Game/Materials/MI_StrippedVertical.MI_StrippedVertical")));
+	InfoIcon = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/Resources/Icons/info.info")));
+	WarningIcon = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/Resources/Icons/Warning.Warning")));
+	ErrorIcon = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/Resources/Icons/Error.Error")));
+	
+	const TArray<FSoftObjectPath> Bundle = {
+		HorizontalStrippedOverlayMat.ToSoftObjectPath(),
+		VerticalStrippedOverlayMat.ToSoftObjectPath(),
+		InfoIcon.ToSoftObjectPath(),
+		WarningIcon.ToSoftObjectPath(),
+		ErrorIcon.ToSoftObjectPath()
+	};
+	BundleHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Bundle, FStreamableDelegate::CreateLambda([]() {
+		UE_LOG(LogTemp, Verbose, TEXT("Shared asset bundle loaded"));
+	}), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UMyAssetCache::Deinitialize() {
+	if (BundleHandle.IsValid()) {
+		BundleHandle->ReleaseHandle();
+		BundleHandle.Reset();
+	}
+	Super::Deinitialize();
+}
+
+/**
+ * Returns the striped overlay displayed on hovered walls
+ * @param bHorizontalWall Whether the wall is horizontal (floors, ceilings) or vertical
+ * @return The overlay material, nullptr if it has not loaded yet
+ */
+UMaterialInterface* UMyAssetCache::GetWallOverlay(const bool bHorizontalWall) const {
+	return bHorizontalWall ? HorizontalStrippedOverlayMat.Get() : VerticalStrippedOverlayMat.Get();
+}
+
+/**
+ * Returns the icon displayed next to a notification
+ * @param NotifyType Severity of the notification
+ * @return The icon, nullptr if it has not loaded yet
+ */
+UTexture2D* UMyAssetCache::GetNotifyIcon(const ENotifyType NotifyType) const {
+	switch (NotifyType) {
+		case Info:
+			return InfoIcon.Get();
+		
+		case Warning:
+			return WarningIcon.Get();
+		
+		case Error:
+			return ErrorIcon.Get();
+		
+		default:
+			return nullptr;
+	}
+}
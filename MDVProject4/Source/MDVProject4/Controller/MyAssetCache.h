@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "MDVProject4/Utils/DataStructures.h"
+#include "MyAssetCache.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Loads the assets shared by every wall and notification (hover overlays and notification icons) once, asynchronously,
+ * when the game instance starts, and keeps them loaded for its lifetime. Until the bundle has loaded the getters return
+ * nullptr, which callers treat as "no overlay" or "no icon"
+ */
+UCLASS()
+class MDVPROJECT4_API UMyAssetCache : public UGameInstanceSubsystem {
+	GENERATED_BODY()
+
+public:
+	static UMyAssetCache* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	UMaterialInterface* GetWallOverlay(bool bHorizontalWall) const;
+
+	UTexture2D* GetNotifyIcon(ENotifyType NotifyType) const;
+
+private:
+	UPROPERTY()
+	TSoftObjectPtr<UMaterialInterface> HorizontalStrippedOverlayMat;
+
+	UPROPERTY()
+	TSoftObjectPtr<UMaterialInterface> VerticalStrippedOverlayMat;
+
+	UPROPERTY()
+	TSoftObjectPtr<UTexture2D> InfoIcon;
+
+	UPROPERTY()
+	TSoftObjectPtr<UTexture2D> WarningIcon;
+
+	UPROPERTY()
+	TSoftObjectPtr<UTexture2D> ErrorIcon;
+
+	// Keeps the bundle loaded
+	TSharedPtr<FStreamableHandle> BundleHandle;
+};
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyFrameScheduler.h"
+
+#include "HAL/IConsoleManager.h"
+#include "MDVProject4/Utils/MyStats.h"
+
+static TAutoConsoleVariable<float> CVarSchedulerBudgetMs(
+	TEXT("MDV.Scheduler.BudgetMs"),
+	4.f,
+	TEXT("Milliseconds of deferred game thread work (tile textures and materials, wall materials, picker widgets) run per frame."),
+	ECVF_Default);
+
+
+/**
+ * Returns the scheduler of the world an object lives in
+ * @param WorldContextObject Any object of the world
+ * @return The scheduler, nullptr if the object is not in a world
+ */
+UMyFrameScheduler* UMyFrameScheduler::Get(const UObject* WorldContextObject) {
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UMyFrameScheduler>() : nullptr;
+}
+
+/**
+ * Drops the work left, its owners being torn down with the world
+ */
+void UMyFrameScheduler::Deinitialize() {
+	for (int32 Priority = 0; Priority < static_cast<int32>(EMyWorkPriority::Count); Priority++) {
+		Queues[Priority].Empty();
+		QueueHeads[Priority] = 0;
+	}
+	FMyStats::SchedulerTicked(0, false);
+	Super::Deinitialize();
+}
+
+/**
+ * Runs queued work, highest priority first, until the frame budget is spent. At least one item runs every frame, so
+ * the queues drain even when a single item takes longer than the budget
+ * @param DeltaTime Unused
+ */
+void UMyFrameScheduler::Tick(float DeltaTime) {
+	if (GetQueueDepth() == 0) {
+		return;
+	}
+	
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_ScheduledWork);
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = FMath::Max(CVarSchedulerBudgetMs.GetValueOnGameThread(), 0.f) / 1000.0;
+	int32 RunCount = 0;
+	while (RunNextItem()) {
+		RunCount++;
+		if (FPlatformTime::Seconds() - StartTime >= Budget) {
+			break;
+		}
+	}
+	
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+	const bool bOverrun = Elapsed > Budget;
+	if (bOverrun) {
+		OverrunCount++;
+		UE_LOG(LogTemp, Verbose, TEXT("Scheduled work took %.2f ms for a budget of %.2f ms (%d items)"), Elapsed * 1000.0, Budget * 1000.0, RunCount);
+	}
+	FMyStats::SchedulerTicked(GetQueueDepth(), bOverrun);
+}
+
+TStatId UMyFrameScheduler::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyFrameScheduler, STATGROUP_Tickables);
+}
+
+/**
+ * Queues work to run on the game thread within the frame budget
+ * @param Owner Object the work belongs to, the work is dropped if it is destroyed first
+ * @param Priority Priority of the work
+ * @param Work Work to run, small enough to fit in a fraction of the budget
+ */
+void UMyFrameScheduler::Submit(const UObject* Owner, const EMyWorkPriority Priority, TUniqueFunction<void()>&& Work) {
+	Queues[static_cast<int32>(Priority)].Add({Owner, MoveTemp(Work)});
+}
+
+/**
+ * Runs all the queued work now, regardless of the budget. Used where the work has to be complete before going on, ie.
+ * when the benchmark measures it
+ */
+void UMyFrameScheduler::Flush() {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_ScheduledWork);
+	while (RunNextItem()) {
+	}
+	FMyStats::SchedulerTicked(0, false);
+}
+
+/**
+ * Runs the oldest item of the highest priority that has one, so work submitted by a running item is ordered with the
+ * rest. Items whose owner has been destroyed are dropped on the way
+ * @return False if there was no work left to run
+ */
+bool UMyFrameScheduler::RunNextItem() {
+	for (int32 Priority = 0; Priority < static_cast<int32>(EMyWorkPriority::Count); Priority++) {
+		TArray<FMyWorkItem>& Queue = Queues[Priority];
+		int32& QueueHead = QueueHeads[Priority];
+		while (QueueHead < Queue.Num()) {
+			// Moved out first, the work may submit more items and reallocate the queue
+			FMyWorkItem Item = MoveTemp(Queue[QueueHead++]);
+			if (QueueHead == Queue.Num()) {
+				Queue.Reset();
+				QueueHead = 0;
+			}
+			if (Item.Owner.IsValid()) {
+				Item.Work();
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Returns the number of work items waiting
+ * @return The number of items of every priority not run yet
+ */
+int32 UMyFrameScheduler::GetQueueDepth() const {
+	int32 QueueDepth = 0;
+	for (int32 Priority = 0; Priority < static_cast<int32>(EMyWorkPriority::Count); Priority++) {
+		QueueDepth += Queues[Priority].Num() - QueueHeads[Priority];
+	}
+	return QueueDepth;
+}
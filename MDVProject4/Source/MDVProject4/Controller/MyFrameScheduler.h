@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyFrameScheduler.generated.h"
+
+// Order in which queued work runs, the work of a priority running before any work of the next
+enum class EMyWorkPriority : uint8 {
+	// Visible to the user right now, ie. materials set on walls
+	High,
+	// Catalog updates, ie. tiles created or reloaded
+	Normal,
+	// Background work, ie. tile picker widgets
+	Low,
+	Count
+};
+
+/**
+ * Runs the game thread work that touches UObjects (textures, material instances, wall materials, grid widgets) as small
+ * items within a time budget per frame, set by MDV.Scheduler.BudgetMs, instead of in one burst. Items of a priority run
+ * in submission order, and an item whose owner has been destroyed is dropped. The queue depth and the frames whose
+ * work overran the budget are reported in "stat MDVProject4" and in Insights
+ */
+UCLASS()
+class MDVPROJECT4_API UMyFrameScheduler : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	static UMyFrameScheduler* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	void Submit(const UObject* Owner, EMyWorkPriority Priority, TUniqueFunction<void()>&& Work);
+
+	void Flush();
+
+	int32 GetQueueDepth() const;
+
+	uint32 GetOverrunCount() const { return OverrunCount; }
+
+private:
+	struct FMyWorkItem {
+		TWeakObjectPtr<const UObject> Owner;
+		TUniqueFunction<void()> Work;
+	};
+
+	// Queue of each priority, consumed from its head index and compacted once drained
+	TArray<FMyWorkItem> Queues[static_cast<int32>(EMyWorkPriority::Count)];
+	int32 QueueHeads[static_cast<int32>(EMyWorkPriority::Count)] = {};
+
+	uint32 OverrunCount = 0;
+
+	bool RunNextItem();
+};
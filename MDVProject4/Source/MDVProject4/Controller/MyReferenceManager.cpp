@@ -3,33 +3,28 @@
 
 #include "MyReferenceManager.h"
 
-#include "Kismet/GameplayStatics.h"
+#include "MyWorldRegistry.h"
 #include "MDVProject4/Objects/AMyActor.h"
 #include "MDVProject4/UI/HUD/MyHUD.h"
 
 
 // Sets default values
 AMyReferenceManager::AMyReferenceManager() {
- 	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-	
+	// The references are filled in by the world registry as the actors register, nothing to do every frame
+	PrimaryActorTick.bCanEverTick = false;
 }
 
-// Called when the game starts or when spawned
-void AMyReferenceManager::BeginPlay() {
-	Super::BeginPlay();
-	
-	MyPawn = Cast<AMyPawn>(UGameplayStatics::GetActorOfClass(GetWorld(), AMyPawn::StaticClass()));
-
-	MyActor = Cast<AMyActor>(UGameplayStatics::GetActorOfClass(GetWorld(), AMyActor::StaticClass()));
-
-	MyController = Cast<AMyController>(UGameplayStatics::GetActorOfClass(GetWorld(), AMyController::StaticClass()));
-	
-	MyHUD = Cast<AMyHUD>(GetWorld()->GetFirstPlayerController()->GetHUD());
+void AMyReferenceManager::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Register(this);
+	}
 }
 
-// Called every frame
-void AMyReferenceManager::Tick(float DeltaTime) {
-	Super::Tick(DeltaTime);
+// Called when the actor is destroyed or the level unloaded
+void AMyReferenceManager::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
-
@@ -21,9 +21,6 @@ public:
 	// Sets default values for this actor's properties
 	AMyReferenceManager();
 
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-	
 	UPROPERTY()
 	AMyPawn* MyPawn;
 
@@ -37,6 +34,7 @@ public:
 	AMyHUD* MyHUD;
 
 protected:
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
+	virtual void PostInitializeComponents() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 };
@@ -6,6 +6,7 @@
 #include "GameFramework/SaveGame.h"
 #include "Containers/Map.h"
 #include "MDVProject4/Objects/AMyActor.h"
+#include "MDVProject4/Utils/DataStructures.h"
 #include "MySaveGame.generated.h"
 
 /**
@@ -25,4 +26,12 @@ public:
 
 	UPROPERTY()
 	TMap<AMyActor*, FString> SaveMap;
+
+	// Content hash of each texture used in SaveMap, to remap walls whose texture has been renamed or moved
+	UPROPERTY()
+	TMap<FString, uint64> ContentHashes;
+
+	// Tile transform of the walls that do not use the default one, streamed out walls included
+	UPROPERTY()
+	TMap<TSoftObjectPtr<AMyActor>, FMyTileTransform> TileTransforms;
 };
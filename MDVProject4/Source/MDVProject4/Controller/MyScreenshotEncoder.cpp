@@ -0,0 +1,421 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyScreenshotEncoder.h"
+
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+// Rows handed to each worker by the stripe-parallel passes
+static constexpr int32 StripeHeight = 64;
+
+static FAutoConsoleCommand BenchmarkEncodersCommand(
+	TEXT("MDV.Screenshot.BenchmarkEncoders"),
+	TEXT("Compares the throughput of the screenshot encoders on fixed test frames. Usage: MDV.Screenshot.BenchmarkEncoders [Width] [Height] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		const int32 Width = Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : 3840;
+		const int32 Height = Args.IsValidIndex(1) ? FCString::Atoi(*Args[1]) : 2160;
+		const int32 Iterations = Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 3;
+		FMyScreenshotEncoder::RunBenchmark(FMath::Max(Width, 1), FMath::Max(Height, 1), FMath::Max(Iterations, 1));
+	}));
+
+
+/**
+ * Encodes a captured frame with the format requested in Settings
+ * @param ImageWrapperModule Image wrapper module, loaded on the game thread beforehand
+ * @param Settings Format and quality to encode with
+ * @param Width Frame width
+ * @param Height Frame height
+ * @param Pixels Frame pixels in BGRA order, its alpha channel is overwritten
+ * @param OutData Encoded file contents
+ * @return True if the frame could be encoded
+ */
+bool FMyScreenshotEncoder::Encode(IImageWrapperModule& ImageWrapperModule, const FScreenshotEncodeSettings& Settings, const int32 Width, const int32 Height, TArray<FColor>& Pixels, TArray64<uint8>& OutData) {
+	if (Pixels.Num() != Width * Height) {
+		return false;
+	}
+	
+	// The captured back buffer has no meaningful alpha, make every pixel opaque before encoding
+	MakeOpaque(Width, Height, Pixels);
+	
+	switch (Settings.Format) {
+		case ScreenshotPNG:
+			return EncodePNG(Settings.Quality, Width, Height, Pixels, OutData);
+
+		case ScreenshotJPEG:
+			return EncodeWithImageWrapper(ImageWrapperModule, EImageFormat::JPEG, FMath::Clamp(Settings.Quality, 1, 100), Width, Height, Pixels, OutData);
+
+		case ScreenshotQOI:
+			EncodeQOI(Width, Height, Pixels, OutData);
+			return true;
+
+		case ScreenshotRaw:
+			EncodeRaw(Width, Height, Pixels, OutData);
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Returns the file extension matching a screenshot format
+ * @param Format Screenshot format
+ * @return The extension, without the dot
+ */
+const TCHAR* FMyScreenshotEncoder::GetFileExtension(const EScreenshotFormat Format) {
+	switch (Format) {
+		case ScreenshotJPEG:	return TEXT("jpg");
+		case ScreenshotQOI:		return TEXT("qoi");
+		case ScreenshotRaw:		return TEXT("raw");
+		default:				return TEXT("png");
+	}
+}
+
+/**
+ * Sets the alpha of every pixel to 255, one stripe of rows per worker
+ * @param Width Frame width
+ * @param Height Frame height
+ * @param Pixels Frame pixels
+ */
+void FMyScreenshotEncoder::MakeOpaque(const int32 Width, const int32 Height, TArray<FColor>& Pixels) {
+	FColor* Data = Pixels.GetData();
+	ParallelForStripes(Height, [Data, Width](const int32 FirstRow, const int32 EndRow) {
+		FColor* const End = Data + static_cast<int64>(EndRow) * Width;
+		for (FColor* Pixel = Data + static_cast<int64>(FirstRow) * Width; Pixel < End; ++Pixel) {
+			Pixel->A = 255;
+		}
+	});
+}
+
+/**
+ * Encodes a frame as an RGB PNG, one stripe of rows per worker: each worker filters its rows and deflates them into a
+ * stream of its own, flushed to a byte boundary, and the streams are chained into a single zlib stream the way pigz
+ * does. Stripes do not share their history, which costs a little ratio against a single stream
+ * @param Level zlib level as in FScreenshotEncodeSettings: 0 for zlib's default, 1 for uncompressed, up to 9
+ * @param Width Frame width
+ * @param Height Frame height
+ * @param Pixels Frame pixels in BGRA order, opaque
+ * @param OutData Encoded file contents
+ * @return True if the frame could be encoded
+ */
+bool FMyScreenshotEncoder::EncodePNG(const int32 Level, const int32 Width, const int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData) {
+	const int32 ZlibLevel = Level == 0 ? Z_DEFAULT_COMPRESSION : Level == 1 ? Z_NO_COMPRESSION : FMath::Min(Level, 9);
+	const int64 RowSize = 1 + static_cast<int64>(Width) * 3;
+	const int32 NumStripes = FMath::DivideAndRoundUp(Height, StripeHeight);
+	
+	struct FStripe {
+		TArray64<uint8> Compressed;
+		uLong Adler = 0;
+		int64 RawSize = 0;
+		bool bCompressed = false;
+	};
+	TArray<FStripe> Stripes;
+	Stripes.SetNum(NumStripes);
+	ParallelForStripes(Height, [&Stripes, &Pixels, Width, Height, RowSize, ZlibLevel](const int32 FirstRow, const int32 EndRow) {
+		FStripe& Stripe = Stripes[FirstRow / StripeHeight];
+		
+		// Up filter, whose previous row is read from the frame so it does not depend on the previous stripe
+		TArray64<uint8> Filtered;
+		Filtered.SetNumUninitialized(RowSize * (EndRow - FirstRow));
+		uint8* Out = Filtered.GetData();
+		for (int32 Row = FirstRow; Row < EndRow; Row++) {
+			const FColor* Pixel = Pixels.GetData() + static_cast<int64>(Row) * Width;
+			const FColor* Above = Row > 0 ? Pixel - Width : nullptr;
+			*Out++ = 2;
+			for (int32 X = 0; X < Width; X++) {
+				*Out++ = static_cast<uint8>(Pixel[X].R - (Above ? Above[X].R : 0));
+				*Out++ = static_cast<uint8>(Pixel[X].G - (Above ? Above[X].G : 0));
+				*Out++ = static_cast<uint8>(Pixel[X].B - (Above ? Above[X].B : 0));
+			}
+		}
+		Stripe.RawSize = Filtered.Num();
+		Stripe.Adler = adler32(adler32(0, nullptr, 0), Filtered.GetData(), Filtered.Num());
+		
+		// Raw deflate, every stripe but the last ending on a sync flush so the next one can follow
+		z_stream Stream = {};
+		if (deflateInit2(&Stream, ZlibLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			return;
+		}
+		Stripe.Compressed.SetNumUninitialized(deflateBound(&Stream, Filtered.Num()) + 16);
+		Stream.next_in = Filtered.GetData();
+		Stream.avail_in = Filtered.Num();
+		Stream.next_out = Stripe.Compressed.GetData();
+		Stream.avail_out = Stripe.Compressed.Num();
+		const int32 Result = deflate(&Stream, EndRow == Height ? Z_FINISH : Z_SYNC_FLUSH);
+		Stripe.bCompressed = Result == (EndRow == Height ? Z_STREAM_END : Z_OK) && Stream.avail_in == 0;
+		Stripe.Compressed.SetNum(Stream.total_out, false);
+		deflateEnd(&Stream);
+	});
+	
+	uLong Adler = adler32(0, nullptr, 0);
+	int64 CompressedSize = 0;
+	for (const FStripe& Stripe : Stripes) {
+		if (!Stripe.bCompressed) {
+			return false;
+		}
+		Adler = adler32_combine(Adler, Stripe.Adler, Stripe.RawSize);
+		CompressedSize += Stripe.Compressed.Num();
+	}
+	
+	// One IDAT chunk per stripe, the first carrying the zlib header and the last the checksum of the whole stream
+	OutData.Reset(8 + 25 + CompressedSize + NumStripes * 12 + 6 + 12);
+	auto WriteBigEndian32 = [&OutData](const uint32 Value) {
+		OutData.Add(static_cast<uint8>(Value >> 24));
+		OutData.Add(static_cast<uint8>(Value >> 16));
+		OutData.Add(static_cast<uint8>(Value >> 8));
+		OutData.Add(static_cast<uint8>(Value));
+	};
+	auto WriteChunk = [&OutData, &WriteBigEndian32](const char* Type, const uint8* Prefix, const int32 PrefixSize, const TArray64<uint8>& Data, const uint8* Suffix, const int32 SuffixSize) {
+		WriteBigEndian32(PrefixSize + Data.Num() + SuffixSize);
+		const int64 TypeOffset = OutData.Num();
+		OutData.Append(reinterpret_cast<const uint8*>(Type), 4);
+		OutData.Append(Prefix, PrefixSize);
+		OutData.Append(Data);
+		OutData.Append(Suffix, SuffixSize);
+		WriteBigEndian32(crc32(0, OutData.GetData() + TypeOffset, OutData.Num() - TypeOffset));
+	};
+	const uint8 Signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	OutData.Append(Signature, sizeof(Signature));
+	const uint8 Header[] = {
+		static_cast<uint8>(Width >> 24), static_cast<uint8>(Width >> 16), static_cast<uint8>(Width >> 8), static_cast<uint8>(Width),
+		static_cast<uint8>(Height >> 24), static_cast<uint8>(Height >> 16), static_cast<uint8>(Height >> 8), static_cast<uint8>(Height),
+		8, 2, 0, 0, 0	// 8 bit RGB, deflate, adaptive filtering, not interlaced
+	};
+	WriteChunk("IHDR", Header, sizeof(Header), TArray64<uint8>(), nullptr, 0);
+	const uint8 ZlibHeader[] = { 0x78, 0x01 };
+	const uint8 Checksum[] = { static_cast<uint8>(Adler >> 24), static_cast<uint8>(Adler >> 16), static_cast<uint8>(Adler >> 8), static_cast<uint8>(Adler) };
+	for (int32 StripeIndex = 0; StripeIndex < NumStripes; StripeIndex++) {
+		WriteChunk("IDAT", ZlibHeader, StripeIndex == 0 ? sizeof(ZlibHeader) : 0, Stripes[StripeIndex].Compressed,
+			Checksum, StripeIndex == NumStripes - 1 ? sizeof(Checksum) : 0);
+	}
+	WriteChunk("IEND", nullptr, 0, TArray64<uint8>(), nullptr, 0);
+	return true;
+}
+
+/**
+ * Encodes through the engine's image wrapper, used for JPEG. libjpeg compresses the frame as a single stream, which
+ * restart intervals would only let us split with an encoder of our own, so it runs on one worker
+ * @param ImageWrapperModule Image wrapper module
+ * @param ImageFormat JPEG
+ * @param Quality Quality, from 1 to 100
+ * @param Width Frame width
+ * @param Height Frame height
+ * @param Pixels Frame pixels in BGRA order
+ * @param OutData Encoded file contents
+ * @return True if the frame could be encoded
+ */
+bool FMyScreenshotEncoder::EncodeWithImageWrapper(IImageWrapperModule& ImageWrapperModule, const EImageFormat ImageFormat, const int32 Quality, const int32 Width, const int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData) {
+	const TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
+	if (!ImageWrapper.IsValid() || !ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Width, Height, ERGBFormat::BGRA, 8)) {
+		return false;
+	}
+	OutData = ImageWrapper->GetCompressed(Quality);
+	return !OutData.IsEmpty();
+}
+
+/**
+ * Encodes a frame as QOI (https://qoiformat.org), a lossless format an order of magnitude faster to write than PNG.
+ * Every QOI op depends on the previous pixel and the running index, so the stream is encoded by a single worker
+ * @param Width Frame width
+ * @param Height Frame height
+ * @param Pixels Frame pixels in BGRA order
+ * @param OutData Encoded file contents
+ */
+void FMyScreenshotEncoder::EncodeQOI(const int32 Width, const int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData) {
+	constexpr uint8 OpIndex = 0x00, OpDiff = 0x40, OpLuma = 0x80, OpRun = 0xc0, OpRGB = 0xfe, OpRGBA = 0xff;
+	constexpr int32 HeaderSize = 14, PaddingSize = 8;
+	
+	// Worst case is one RGBA op per pixel
+	OutData.SetNumUninitialized(HeaderSize + static_cast<int64>(Pixels.Num()) * 5 + PaddingSize);
+	uint8* Out = OutData.GetData();
+	
+	auto WriteBigEndian32 = [&Out](const uint32 Value) {
+		*Out++ = static_cast<uint8>(Value >> 24);
+		*Out++ = static_cast<uint8>(Value >> 16);
+		*Out++ = static_cast<uint8>(Value >> 8);
+		*Out++ = static_cast<uint8>(Value);
+	};
+	*Out++ = 'q'; *Out++ = 'o'; *Out++ = 'i'; *Out++ = 'f';
+	WriteBigEndian32(Width);
+	WriteBigEndian32(Height);
+	*Out++ = 4;	// RGBA channels
+	*Out++ = 0;	// sRGB with linear alpha
+
+	FColor Index[64];
+	FMemory::Memzero(Index);
+	FColor Previous(0, 0, 0, 255);
+	int32 Run = 0;
+	const int32 LastPixel = Pixels.Num() - 1;
+	
+	for (int32 PixelIndex = 0; PixelIndex <= LastPixel; PixelIndex++) {
+		const FColor Pixel = Pixels[PixelIndex];
+		if (Pixel == Previous) {
+			Run++;
+			if (Run == 62 || PixelIndex == LastPixel) {
+				*Out++ = static_cast<uint8>(OpRun | (Run - 1));
+				Run = 0;
+			}
+			continue;
+		}
+		
+		if (Run > 0) {
+			*Out++ = static_cast<uint8>(OpRun | (Run - 1));
+			Run = 0;
+		}
+
+		const int32 Hash = (Pixel.R * 3 + Pixel.G * 5 + Pixel.B * 7 + Pixel.A * 11) % 64;
+		if (Index[Hash] == Pixel) {
+			*Out++ = static_cast<uint8>(OpIndex | Hash);
+		} else {
+			Index[Hash] = Pixel;
+			if (Pixel.A == Previous.A) {
+				const int8 DiffR = static_cast<int8>(Pixel.R - Previous.R);
+				const int8 DiffG = static_cast<int8>(Pixel.G - Previous.G);
+				const int8 DiffB = static_cast<int8>(Pixel.B - Previous.B);
+				const int8 DiffGR = DiffR - DiffG;
+				const int8 DiffGB = DiffB - DiffG;
+				
+				if (DiffR > -3 && DiffR < 2 && DiffG > -3 && DiffG < 2 && DiffB > -3 && DiffB < 2) {
+					*Out++ = static_cast<uint8>(OpDiff | (DiffR + 2) << 4 | (DiffG + 2) << 2 | (DiffB + 2));
+				} else if (DiffGR > -9 && DiffGR < 8 && DiffG > -33 && DiffG < 32 && DiffGB > -9 && DiffGB < 8) {
+					*Out++ = static_cast<uint8>(OpLuma | (DiffG + 32));
+					*Out++ = static_cast<uint8>((DiffGR + 8) << 4 | (DiffGB + 8));
+				} else {
+					*Out++ = OpRGB;
+					*Out++ = Pixel.R;
+					*Out++ = Pixel.G;
+					*Out++ = Pixel.B;
+				}
+			} else {
+				*Out++ = OpRGBA;
+				*Out++ = Pixel.R;
+				*Out++ = Pixel.G;
+				*Out++ = Pixel.B;
+				*Out++ = Pixel.A;
+			}
+		}
+		Previous = Pixel;
+	}
+
+	// End marker
+	for (int32 PaddingIndex = 0; PaddingIndex < PaddingSize - 1; PaddingIndex++) {
+		*Out++ = 0;
+	}
+	*Out++ = 1;
+	
+	OutData.SetNum(Out - OutData.GetData(), false);
+}
+
+/**
+ * Dumps the frame as tightly packed BGRA8 rows, copied one stripe of rows per worker
+ * @param Width Frame width
+ * @param Height Frame height
+ * @param Pixels Frame pixels in BGRA order
+ * @param OutData Raw file contents
+ */
+void FMyScreenshotEncoder::EncodeRaw(const int32 Width, const int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData) {
+	const int64 RowSize = static_cast<int64>(Width) * sizeof(FColor);
+	OutData.SetNumUninitialized(RowSize * Height);
+	
+	const uint8* Source = reinterpret_cast<const uint8*>(Pixels.GetData());
+	uint8* Destination = OutData.GetData();
+	ParallelForStripes(Height, [Source, Destination, RowSize](const int32 FirstRow, const int32 EndRow) {
+		FMemory::Memcpy(Destination + FirstRow * RowSize, Source + FirstRow * RowSize, (EndRow - FirstRow) * RowSize);
+	});
+}
+
+/**
+ * Splits the rows of a frame into stripes and runs Body on each of them in parallel
+ * @param Height Frame height
+ * @param Body Function called with the first row and the end row (exclusive) of each stripe
+ */
+void FMyScreenshotEncoder::ParallelForStripes(const int32 Height, TFunctionRef<void(int32 FirstRow, int32 EndRow)> Body) {
+	const int32 NumStripes = FMath::DivideAndRoundUp(Height, StripeHeight);
+	ParallelFor(NumStripes, [Height, &Body](const int32 StripeIndex) {
+		const int32 FirstRow = StripeIndex * StripeHeight;
+		Body(FirstRow, FMath::Min(FirstRow + StripeHeight, Height));
+	});
+}
+
+/**
+ * Encodes fixed test frames with every encoder and logs their throughput. The frames are generated from a fixed seed,
+ * one smooth (gradients, like walls under soft light) and one noisy (worst case for every lossless encoder)
+ * @param Width Test frame width
+ * @param Height Test frame height
+ * @param Iterations Encodes per encoder and frame, the best time is kept
+ */
+void FMyScreenshotEncoder::RunBenchmark(const int32 Width, const int32 Height, const int32 Iterations) {
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	
+	TArray<FColor> SmoothFrame, NoisyFrame;
+	SmoothFrame.SetNumUninitialized(Width * Height);
+	NoisyFrame.SetNumUninitialized(Width * Height);
+	FRandomStream RandomStream(0x4D4456);
+	for (int32 Y = 0; Y < Height; Y++) {
+		for (int32 X = 0; X < Width; X++) {
+			SmoothFrame[Y * Width + X] = FColor(X * 255 / Width, Y * 255 / Height, (X + Y) * 127 / (Width + Height) + 64, 255);
+			NoisyFrame[Y * Width + X] = FColor(RandomStream.RandRange(0, 255), RandomStream.RandRange(0, 255), RandomStream.RandRange(0, 255), 255);
+		}
+	}
+
+	struct FBenchmarkCase {
+		const TCHAR* Name;
+		FScreenshotEncodeSettings Settings;
+	};
+	TArray<FBenchmarkCase> Cases;
+	auto AddCase = [&Cases](const TCHAR* Name, const EScreenshotFormat Format, const int32 Quality) {
+		FScreenshotEncodeSettings Settings;
+		Settings.Format = Format;
+		Settings.Quality = Quality;
+		Cases.Add({Name, Settings});
+	};
+	AddCase(TEXT("PNG default"), ScreenshotPNG, 0);
+	AddCase(TEXT("PNG uncompressed"), ScreenshotPNG, 1);
+	AddCase(TEXT("PNG level 3"), ScreenshotPNG, 3);
+	AddCase(TEXT("PNG level 9"), ScreenshotPNG, 9);
+	AddCase(TEXT("JPEG 90"), ScreenshotJPEG, 90);
+	AddCase(TEXT("JPEG 75"), ScreenshotJPEG, 75);
+	AddCase(TEXT("QOI"), ScreenshotQOI, 0);
+	AddCase(TEXT("Raw"), ScreenshotRaw, 0);
+
+	const double FrameMegabytes = static_cast<double>(Width) * Height * sizeof(FColor) / (1024.0 * 1024.0);
+	UE_LOG(LogTemp, Display, TEXT("Screenshot encoder benchmark: %dx%d, %d iterations"), Width, Height, Iterations);
+	
+	const TCHAR* FrameNames[] = { TEXT("smooth"), TEXT("noisy") };
+	const TArray<FColor>* Frames[] = { &SmoothFrame, &NoisyFrame };
+	
+	for (int32 FrameIndex = 0; FrameIndex < UE_ARRAY_COUNT(Frames); FrameIndex++) {
+		for (const FBenchmarkCase& Case : Cases) {
+			double BestSeconds = TNumericLimits<double>::Max();
+			int64 EncodedSize = 0;
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++) {
+				TArray<FColor> Pixels(*Frames[FrameIndex]);
+				TArray64<uint8> EncodedData;
+				
+				const double StartTime = FPlatformTime::Seconds();
+				const bool bEncoded = Encode(ImageWrapperModule, Case.Settings, Width, Height, Pixels, EncodedData);
+				const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+				
+				if (!bEncoded) {
+					UE_LOG(LogTemp, Warning, TEXT("  %s failed to encode the %s frame"), Case.Name, FrameNames[FrameIndex]);
+					break;
+				}
+				BestSeconds = FMath::Min(BestSeconds, ElapsedSeconds);
+				EncodedSize = EncodedData.Num();
+			}
+			
+			if (EncodedSize > 0) {
+				UE_LOG(LogTemp, Display, TEXT("  [%s] %-16s %8.2f ms %8.1f MB/s  ratio %5.1f%%"),
+					FrameNames[FrameIndex], Case.Name, BestSeconds * 1000.0, FrameMegabytes / BestSeconds,
+					100.0 * EncodedSize / (FrameMegabytes * 1024.0 * 1024.0));
+			}
+		}
+	}
+}
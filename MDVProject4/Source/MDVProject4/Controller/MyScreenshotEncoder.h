@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IImageWrapper.h"
+#include "MDVProject4/Utils/DataStructures.h"
+
+class IImageWrapperModule;
+
+/**
+ * Encodes captured BGRA frames into the screenshot formats offered by the screenshot service. Everything in here is
+ * meant to run on worker threads, except GetFileExtension which is safe everywhere
+ */
+class MDVPROJECT4_API FMyScreenshotEncoder {
+public:
+	static bool Encode(IImageWrapperModule& ImageWrapperModule, const FScreenshotEncodeSettings& Settings, int32 Width, int32 Height, TArray<FColor>& Pixels, TArray64<uint8>& OutData);
+
+	static const TCHAR* GetFileExtension(EScreenshotFormat Format);
+
+	static void RunBenchmark(int32 Width, int32 Height, int32 Iterations);
+
+private:
+	static void MakeOpaque(int32 Width, int32 Height, TArray<FColor>& Pixels);
+
+	static bool EncodePNG(int32 Level, int32 Width, int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData);
+
+	static bool EncodeWithImageWrapper(IImageWrapperModule& ImageWrapperModule, EImageFormat ImageFormat, int32 Quality, int32 Width, int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData);
+
+	static void EncodeQOI(int32 Width, int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData);
+
+	static void EncodeRaw(int32 Width, int32 Height, const TArray<FColor>& Pixels, TArray64<uint8>& OutData);
+
+	static void ParallelForStripes(int32 Height, TFunctionRef<void(int32 FirstRow, int32 EndRow)> Body);
+};
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyScreenshotService.h"
+
+#include "IImageWrapperModule.h"
+#include "MyScreenshotEncoder.h"
+#include "UnrealClient.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/Texture2D.h"
+#include "Tasks/Task.h"
+#include "MDVProject4/Utils/Defines.h"
+#include "MDVProject4/Utils/ImageKernels.h"
+#include "MDVProject4/Utils/MyStats.h"
+
+
+/**
+ * Registers the one and only screenshot handler of the service
+ */
+void UMyScreenshotService::Initialise() {
+	if (!ScreenshotDelegateHandle.IsValid()) {
+		ScreenshotDelegateHandle = UGameViewportClient::OnScreenshotCaptured().AddUObject(this, &UMyScreenshotService::ScreenshotCaptured);
+	}
+}
+
+/**
+ * Unregisters the screenshot handler and drops the requests that have not been captured yet
+ */
+void UMyScreenshotService::Shutdown() {
+	UGameViewportClient::OnScreenshotCaptured().Remove(ScreenshotDelegateHandle);
+	ScreenshotDelegateHandle.Reset();
+	PendingRequests.Reset();
+	InFlightRequest.Reset();
+}
+
+/**
+ * Queues a screenshot. Requests are captured one per frame in the order they were made, so a burst of screenshots
+ * (ie. one per design variant) can be requested at once
+ * @param ScreenshotName Name of the screenshot file, without extension
+ * @param EncodeSettings Format and quality the screenshot is saved with
+ * @param PrepareCapture Optional function called right before this screenshot is captured, ie. to apply a variant
+ * @return The identifier of the request, reported back by OnScreenshotSaved
+ */
+int32 UMyScreenshotService::RequestScreenshot(const FString& ScreenshotName, const FScreenshotEncodeSettings& EncodeSettings, TFunction<void()> PrepareCapture) {
+	const int32 RequestId = NextRequestId++;
+	const TCHAR* Extension = FMyScreenshotEncoder::GetFileExtension(EncodeSettings.Format);
+	
+	// Two requests of a burst sharing the same name would race for the same file, disambiguate them with the request ID
+	FString Filename = FString::Printf(TEXT("%s/%s.%s"), *GetScreenshotDirectory(), *ScreenshotName, Extension);
+	if (IsFilenameQueued(Filename)) {
+		Filename = FString::Printf(TEXT("%s/%s_%d.%s"), *GetScreenshotDirectory(), *ScreenshotName, RequestId, Extension);
+	}
+	
+	PendingRequests.Add({RequestId, Filename, EncodeSettings, MoveTemp(PrepareCapture)});
+	IssueNextRequest();
+	return RequestId;
+}
+
+/**
+ * Returns how many requests have not been captured yet, including the one being captured
+ * @return The number of requests waiting for a capture
+ */
+int32 UMyScreenshotService::GetPendingRequestCount() const {
+	return PendingRequests.Num() + (InFlightRequest.IsSet() ? 1 : 0);
+}
+
+/**
+ * Returns the directory where screenshots are stored, next to main UProject/EXE based on the build type
+ * @return The screenshot directory
+ */
+FString UMyScreenshotService::GetScreenshotDirectory() {
+	#if WITH_EDITOR
+		return FString::Printf(TEXT("%s/%s"), *FPaths::ProjectDir(), TEXT("Screenshots"));
+	#else
+		return FString::Printf(TEXT("%s/../%s"), *FPaths::ProjectDir(), TEXT("Screenshots"));
+	#endif
+}
+
+/**
+ * Checks if a request, a capture or a background write already targets the given file
+ * @param Filename File to check
+ * @return True if the file is already in use by the service
+ */
+bool UMyScreenshotService::IsFilenameQueued(const FString& Filename) const {
+	if (FilenamesBeingWritten.Contains(Filename) || (InFlightRequest.IsSet() && InFlightRequest->Filename == Filename)) {
+		return true;
+	}
+	return PendingRequests.ContainsByPredicate([&Filename](const FMyScreenshotJob& Job) {
+		return Job.Filename == Filename;
+	});
+}
+
+/**
+ * Asks the engine to capture the oldest pending request, unless a capture is already in flight
+ */
+void UMyScreenshotService::IssueNextRequest() {
+	if (InFlightRequest.IsSet() || PendingRequests.IsEmpty()) {
+		return;
+	}
+
+	InFlightRequest = MoveTemp(PendingRequests[0]);
+	PendingRequests.RemoveAt(0);
+	if (InFlightRequest->PrepareCapture) {
+		InFlightRequest->PrepareCapture();
+	}
+	FScreenshotRequest::RequestScreenshot(InFlightRequest->Filename, false, false);
+}
+
+/**
+ * Issues the next request on the following frame. The engine resets the screenshot request right after broadcasting a
+ * capture, so a request made from within the capture callback would be lost
+ */
+void UMyScreenshotService::ScheduleNextRequest() {
+	if (PendingRequests.IsEmpty()) {
+		return;
+	}
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float) {
+		IssueNextRequest();
+		return false;
+	}));
+}
+
+/**
+ * Called via delegate once the request to create a screenshot has been carried out. The bitmap is only lent for the
+ * duration of the callback, so it is copied once and moved into a worker task that does all the encoding and I/O
+ * @param Width Screenshot width
+ * @param Height Screenshot height
+ * @param Bitmap Array of bits that specify the color of each pixel in a rectangular array of pixels
+ */
+void UMyScreenshotService::ScreenshotCaptured(int32 Width, int32 Height, const TArray<FColor>& Bitmap) {
+	if (!InFlightRequest.IsSet()) {
+		// Screenshot requested by someone else (ie. the console), let it be
+		return;
+	}
+	const int32 RequestId = InFlightRequest->RequestId;
+	const FString Filename = InFlightRequest->Filename;
+	const FScreenshotEncodeSettings EncodeSettings = InFlightRequest->EncodeSettings;
+	InFlightRequest.Reset();
+	FilenamesBeingWritten.Add(Filename);
+	
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	TWeakObjectPtr<UMyScreenshotService> WeakThis(this);
+	
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [&ImageWrapperModule, WeakThis, RequestId, EncodeSettings, Width, Height, Pixels = TArray<FColor>(Bitmap), Filename]() mutable {
+		// Build the small preview first so the screenshot effect does not wait for the encoder
+		int32 PreviewWidth, PreviewHeight;
+		TArray<FColor> PreviewPixels;
+		const int32 Factor = FMyImageKernels::GetDownsampleFactor(Width, M_SCREENSHOT_PREVIEW_MAX_WIDTH);
+		FMyImageKernels::BoxDownsample(Pixels.GetData(), Width, Height, Factor, PreviewPixels, PreviewWidth, PreviewHeight);
+		
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, RequestId, PreviewWidth, PreviewHeight, PreviewPixels = MoveTemp(PreviewPixels)]() mutable {
+			if (UMyScreenshotService* This = WeakThis.Get()) {
+				This->OnScreenshotPreviewReady.Broadcast(RequestId, This->UpdatePreviewTexture(PreviewWidth, PreviewHeight, MoveTemp(PreviewPixels)));
+			}
+		});
+		
+		const bool bSaved = EncodeAndSaveScreenshot(ImageWrapperModule, EncodeSettings, Width, Height, Pixels, Filename);
+
+		// Report back on the game thread
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, RequestId, Filename, bSaved]() {
+			if (UMyScreenshotService* This = WeakThis.Get()) {
+				This->FilenamesBeingWritten.Remove(Filename);
+				This->OnScreenshotSaved.Broadcast(RequestId, Filename, bSaved);
+			}
+		});
+	});
+
+	ScheduleNextRequest();
+}
+
+/**
+ * Encodes the screenshot with the requested encoder and writes it to disk. Runs on a worker thread
+ * @param ImageWrapperModule Image wrapper module, loaded on the game thread beforehand
+ * @param EncodeSettings Format and quality to encode with
+ * @param Width Screenshot width
+ * @param Height Screenshot height
+ * @param Pixels Screenshot pixels in BGRA order, its alpha channel is overwritten
+ * @param Filename Destination of the encoded screenshot
+ * @return True if the screenshot has been written to Filename
+ */
+bool UMyScreenshotService::EncodeAndSaveScreenshot(IImageWrapperModule& ImageWrapperModule, const FScreenshotEncodeSettings& EncodeSettings, const int32 Width, const int32 Height, TArray<FColor>& Pixels, const FString& Filename) {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_ScreenshotEncode);
+	TArray64<uint8> ImageData;
+	if (!FMyScreenshotEncoder::Encode(ImageWrapperModule, EncodeSettings, Width, Height, Pixels, ImageData)) {
+		return false;
+	}
+
+	// Write to a temporary file first and rename it, so a partially written screenshot never exists under Filename
+	const FString TempFilename = Filename + TEXT(".tmp");
+	return FFileHelper::SaveArrayToFile(ImageData, *TempFilename)
+		&& IFileManager::Get().Move(*Filename, *TempFilename, true, true);
+}
+
+/**
+ * Writes a screenshot preview into the pooled preview texture. The texture is only reallocated when the preview size
+ * changes (ie. the viewport was resized), and the pixels are handed over to the render thread, which uploads and frees
+ * them, so the game thread does not copy them
+ * @param Width Preview width
+ * @param Height Preview height
+ * @param Pixels Preview pixels in BGRA order
+ * @return The preview texture, nullptr if it could not be created
+ */
+UTexture2D* UMyScreenshotService::UpdatePreviewTexture(const int32 Width, const int32 Height, TArray<FColor>&& Pixels) {
+	if (!PreviewTexture || PreviewTexture->GetSizeX() != Width || PreviewTexture->GetSizeY() != Height) {
+		MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_TextureCreation);
+		PreviewTexture = UTexture2D::CreateTransient(Width, Height);
+		if (!PreviewTexture) {
+			return nullptr;
+		}
+		PreviewTexture->CompressionSettings = TC_Displacementmap;
+		PreviewTexture->SRGB = 0;
+		PreviewTexture->UpdateResource();
+	}
+
+	TArray<FColor>* OwnedPixels = new TArray<FColor>(MoveTemp(Pixels));
+	FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, Width, Height);
+	PreviewTexture->UpdateTextureRegions(0, 1, Region, Width * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(OwnedPixels->GetData()),
+		[OwnedPixels](uint8*, const FUpdateTextureRegion2D* Regions) {
+			delete OwnedPixels;
+			delete Regions;
+		});
+	return PreviewTexture;
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "MDVProject4/Utils/DataStructures.h"
+#include "MyScreenshotService.generated.h"
+
+class IImageWrapperModule;
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnScreenshotPreviewReady, int32 /*RequestId*/, UTexture2D* /*PreviewTexture*/);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnScreenshotSaved, int32 /*RequestId*/, const FString& /*Filename*/, bool /*bSaved*/);
+
+/**
+ * Queues screenshot requests and captures them one at a time through a single viewport delegate. Each capture is
+ * encoded and written in the background to the output path of its own request
+ */
+UCLASS()
+class MDVPROJECT4_API UMyScreenshotService : public UObject {
+	GENERATED_BODY()
+
+public:
+	void Initialise();
+
+	void Shutdown();
+
+	int32 RequestScreenshot(const FString& ScreenshotName, const FScreenshotEncodeSettings& EncodeSettings = FScreenshotEncodeSettings(), TFunction<void()> PrepareCapture = nullptr);
+
+	int32 GetPendingRequestCount() const;
+
+	static FString GetScreenshotDirectory();
+
+	FOnScreenshotPreviewReady OnScreenshotPreviewReady;
+
+	FOnScreenshotSaved OnScreenshotSaved;
+
+private:
+	struct FMyScreenshotJob {
+		int32 RequestId;
+		FString Filename;
+		FScreenshotEncodeSettings EncodeSettings;
+		TFunction<void()> PrepareCapture;
+	};
+	
+	void IssueNextRequest();
+
+	void ScheduleNextRequest();
+
+	void ScreenshotCaptured(int32 Width, int32 Height, const TArray<FColor>& Bitmap);
+
+	bool IsFilenameQueued(const FString& Filename) const;
+
+	static bool EncodeAndSaveScreenshot(IImageWrapperModule& ImageWrapperModule, const FScreenshotEncodeSettings& EncodeSettings, int32 Width, int32 Height, TArray<FColor>& Pixels, const FString& Filename);
+
+	UTexture2D* UpdatePreviewTexture(int32 Width, int32 Height, TArray<FColor>&& Pixels);
+
+	UPROPERTY()
+	UTexture2D* PreviewTexture;
+
+	TArray<FMyScreenshotJob> PendingRequests;
+
+	TOptional<FMyScreenshotJob> InFlightRequest;
+
+	TSet<FString> FilenamesBeingWritten;
+
+	FDelegateHandle ScreenshotDelegateHandle;
+
+	int32 NextRequestId = 1;
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyTextureUploader.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "MDVProject4/Utils/MyStats.h"
+
+static TAutoConsoleVariable<int32> CVarUploadBudgetKB(
+	TEXT("MDV.Upload.BudgetKB"),
+	8192,
+	TEXT("Kilobytes of full resolution tile textures uploaded per frame, tiles on screen first."),
+	ECVF_Default);
+
+
+/**
+ * Returns the texture uploader of the world an object lives in
+ * @param WorldContextObject Any object of the world
+ * @return The uploader, nullptr if the object is not in a world
+ */
+UMyTextureUploader* UMyTextureUploader::Get(const UObject* WorldContextObject) {
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UMyTextureUploader>() : nullptr;
+}
+
+/**
+ * Drops the uploads left, their tiles being torn down with the world
+ */
+void UMyTextureUploader::Deinitialize() {
+	Uploads.Empty();
+	PendingBytes = 0;
+	FMyStats::UploaderTicked(0, 0, 0);
+	Super::Deinitialize();
+}
+
+/**
+ * Runs the uploads of the tiles on screen, then the others, as long as they fit in the frame budget. The first upload
+ * always runs, so an upload larger than the budget is not held back forever
+ * @param DeltaTime Unused
+ */
+void UMyTextureUploader::Tick(float DeltaTime) {
+	if (Uploads.IsEmpty()) {
+		return;
+	}
+	
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_TextureUpload);
+	const int64 Budget = static_cast<int64>(FMath::Max(CVarUploadBudgetKB.GetValueOnGameThread(), 0)) * 1024;
+	TSet<const UMaterialInterface*> VisibleMaterials;
+	OnGatherVisibleMaterials.Broadcast(VisibleMaterials);
+	
+	// Moved out first, an upload may submit or cancel others
+	TArray<FMyTextureUpload> FrameUploads;
+	int64 FrameBytes = 0;
+	for (const bool bVisible : {true, false}) {
+		for (FMyTextureUpload& Upload : Uploads) {
+			if (Upload.Upload && Upload.DynamicMaterial.IsValid() && VisibleMaterials.Contains(Upload.DynamicMaterial.Get()) == bVisible
+				&& (FrameBytes == 0 || FrameBytes + Upload.Bytes <= Budget)) {
+				FrameBytes += Upload.Bytes;
+				FrameUploads.Add(MoveTemp(Upload));
+				Upload.Upload = nullptr;
+			}
+		}
+	}
+	// Taken for this frame, or bound to a destroyed material
+	Uploads.RemoveAll([this](const FMyTextureUpload& Upload) {
+		if (Upload.Upload && !Upload.DynamicMaterial.IsValid()) {
+			PendingBytes -= Upload.Bytes;
+		}
+		return !Upload.Upload || !Upload.DynamicMaterial.IsValid();
+	});
+	
+	for (FMyTextureUpload& Upload : FrameUploads) {
+		PendingBytes -= Upload.Bytes;
+		Upload.Upload();
+	}
+	FMyStats::UploaderTicked(Uploads.Num(), PendingBytes, FrameBytes);
+}
+
+TStatId UMyTextureUploader::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyTextureUploader, STATGROUP_Tickables);
+}
+
+/**
+ * Queues the upload of the full resolution textures of a tile
+ * @param DynamicMaterial Material of the tile, which the upload binds the textures to
+ * @param Bytes Size of the textures uploaded
+ * @param Upload Creates the textures and binds them
+ */
+void UMyTextureUploader::Submit(UMaterialInstanceDynamic* DynamicMaterial, const int64 Bytes, TUniqueFunction<void()>&& Upload) {
+	Uploads.Add({DynamicMaterial, Bytes, MoveTemp(Upload)});
+	PendingBytes += Bytes;
+}
+
+/**
+ * Drops the uploads bound to a material, whose tile has left the catalog
+ * @param DynamicMaterial Material of the tile
+ */
+void UMyTextureUploader::Cancel(const UMaterialInterface* DynamicMaterial) {
+	Uploads.RemoveAll([this, DynamicMaterial](const FMyTextureUpload& Upload) {
+		if (Upload.DynamicMaterial.Get() == DynamicMaterial) {
+			PendingBytes -= Upload.Bytes;
+			return true;
+		}
+		return false;
+	});
+}
+
+/**
+ * Runs all the queued uploads now, regardless of the budget. Used where the tiles have to be complete before going on,
+ * ie. when the benchmark measures them
+ */
+void UMyTextureUploader::Flush() {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_TextureUpload);
+	while (!Uploads.IsEmpty()) {
+		TArray<FMyTextureUpload> FrameUploads = MoveTemp(Uploads);
+		Uploads.Reset();
+		for (FMyTextureUpload& Upload : FrameUploads) {
+			PendingBytes -= Upload.Bytes;
+			if (Upload.DynamicMaterial.IsValid()) {
+				Upload.Upload();
+			}
+		}
+	}
+	FMyStats::UploaderTicked(0, 0, 0);
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyTextureUploader.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FMyOnGatherVisibleMaterials, TSet<const UMaterialInterface*>& /*VisibleMaterials*/);
+
+/**
+ * Uploads the full resolution textures of tiles, which are created with a preview of their low mips, within a budget of
+ * bytes per frame set by MDV.Upload.BudgetKB, so a burst of imported tiles does not stall the render thread. Uploads
+ * of the tiles the user can see, gathered every frame through OnGatherVisibleMaterials, go first, the others in
+ * submission order. An upload larger than the budget runs alone in its frame
+ */
+UCLASS()
+class MDVPROJECT4_API UMyTextureUploader : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	static UMyTextureUploader* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	void Submit(UMaterialInstanceDynamic* DynamicMaterial, int64 Bytes, TUniqueFunction<void()>&& Upload);
+
+	void Cancel(const UMaterialInterface* DynamicMaterial);
+
+	void Flush();
+
+	int32 GetQueueDepth() const { return Uploads.Num(); }
+
+	// Filled with the materials of the walls and picker tiles on screen, whose uploads are prioritised
+	FMyOnGatherVisibleMaterials OnGatherVisibleMaterials;
+
+private:
+	struct FMyTextureUpload {
+		// Material the textures are bound to, the upload is dropped if it is destroyed first
+		TWeakObjectPtr<UMaterialInstanceDynamic> DynamicMaterial;
+		int64 Bytes = 0;
+		TUniqueFunction<void()> Upload;
+	};
+
+	// Oldest first
+	TArray<FMyTextureUpload> Uploads;
+
+	int64 PendingBytes = 0;
+};
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyTilePool.h"
+
+#include "ImageCore.h"
+#include "ImageCoreUtils.h"
+#include "EditorFramework/AssetImportData.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "MDVProject4/Utils/Defines.h"
+#include "MDVProject4/Utils/MyStats.h"
+
+
+/**
+ * Returns the tile pool of the world an object lives in
+ * @param WorldContextObject Any object of the world
+ * @return The pool, nullptr if the object is not in a world
+ */
+UMyTilePool* UMyTilePool::Get(const UObject* WorldContextObject) {
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UMyTilePool>() : nullptr;
+}
+
+/**
+ * Logs how often the pool was hit and releases what it holds to the garbage collector
+ */
+void UMyTilePool::Deinitialize() {
+	if (TextureHits + TextureMisses > 0) {
+		UE_LOG(LogTemp, Display, TEXT("Tile pool: %u of %u textures and %u of %u material instances reused"),
+			TextureHits, TextureHits + TextureMisses, MaterialHits, MaterialHits + MaterialMisses);
+	}
+	FMyStats::TilePoolChanged(-PooledBytes);
+	PooledTextures.Empty();
+	PooledMaterials.Empty();
+	PooledBytes = 0;
+	Super::Deinitialize();
+}
+
+/**
+ * Creates or reuses a texture holding an image, like FImageUtils::CreateTexture2DFromImage()
+ * @param Image Image of the texture, converted if the GPU has no matching format
+ * @return The texture, with a single mip
+ */
+UTexture2D* UMyTilePool::CreateTexture(const FImage& Image) {
+	ERawImageFormat::Type RawFormat;
+	const EPixelFormat PixelFormat = FImageCoreUtils::GetPixelFormatForRawImageFormat(Image.Format, &RawFormat);
+	FImage ConvertedImage;
+	const FImage* SourceImage = &Image;
+	if (RawFormat != Image.Format) {
+		Image.CopyTo(ConvertedImage, RawFormat, Image.GammaSpace);
+		SourceImage = &ConvertedImage;
+	}
+	const FMyTextureMip Mip = {SourceImage->RawData.GetData(), SourceImage->RawData.Num(), Image.SizeX, Image.SizeY};
+	return CreateTexture(PixelFormat, Image.GammaSpace != EGammaSpace::Linear, MakeArrayView(&Mip, 1));
+}
+
+/**
+ * Creates a texture from its mip chain, or reuses the most recently released one of the same size, format and mip
+ * count, uploading the mips into its GPU texture
+ * @param PixelFormat Format of the mips
+ * @param bSRGB Whether the texture holds sRGB colors
+ * @param Mips Mip chain, largest first. The data is copied
+ * @return The texture
+ */
+UTexture2D* UMyTilePool::CreateTexture(const EPixelFormat PixelFormat, const bool bSRGB, const TConstArrayView<FMyTextureMip> Mips) {
+	const int32 PooledIndex = PooledTextures.FindLastByPredicate([PixelFormat, bSRGB, &Mips](const UTexture2D* PooledTexture) {
+		return PooledTexture->GetPixelFormat() == PixelFormat && PooledTexture->SRGB == bSRGB && PooledTexture->GetNumMips() == Mips.Num()
+			&& PooledTexture->GetSizeX() == Mips[0].Width && PooledTexture->GetSizeY() == Mips[0].Height;
+	});
+	FMyStats::TexturePoolAcquired(PooledIndex != INDEX_NONE);
+	if (PooledIndex != INDEX_NONE) {
+		TextureHits++;
+		UTexture2D* Texture = PooledTextures[PooledIndex];
+		PooledTextures.RemoveAt(PooledIndex);
+		const int64 TextureBytes = Texture->CalcTextureMemorySizeEnum(TMC_AllMips);
+		PooledBytes -= TextureBytes;
+		FMyStats::TilePoolChanged(-TextureBytes);
+		for (int32 MipIndex = 0; MipIndex < Mips.Num(); MipIndex++) {
+			UploadMip(Texture, MipIndex, Mips[MipIndex]);
+		}
+		return Texture;
+	}
+	
+	TextureMisses++;
+	FTexturePlatformData* PlatformData = new FTexturePlatformData();
+	PlatformData->SizeX = Mips[0].Width;
+	PlatformData->SizeY = Mips[0].Height;
+	PlatformData->PixelFormat = PixelFormat;
+	for (const FMyTextureMip& Mip : Mips) {
+		FTexture2DMipMap* TextureMip = new FTexture2DMipMap(Mip.Width, Mip.Height);
+		PlatformData->Mips.Add(TextureMip);
+		TextureMip->BulkData.Lock(LOCK_READ_WRITE);
+		FMemory::Memcpy(TextureMip->BulkData.Realloc(Mip.Size), Mip.Data, Mip.Size);
+		TextureMip->BulkData.Unlock();
+	}
+	
+	UTexture2D* Texture = NewObject<UTexture2D>(GetTransientPackage(), NAME_None, RF_Transient);
+	Texture->SetPlatformData(PlatformData);
+	Texture->SRGB = bSRGB;
+	Texture->NeverStream = true;
+	Texture->UpdateResource();
+	return Texture;
+}
+
+/**
+ * Creates a material instance, or reuses the most recently released one of the same parent
+ * @param Parent Parent material
+ * @return The material instance, without parameter values
+ */
+UMaterialInstanceDynamic* UMyTilePool::CreateMaterial(UMaterialInterface* Parent) {
+	const int32 PooledIndex = PooledMaterials.FindLastByPredicate([Parent](const UMaterialInstanceDynamic* PooledMaterial) {
+		return PooledMaterial->Parent == Parent;
+	});
+	FMyStats::MaterialPoolAcquired(PooledIndex != INDEX_NONE);
+	if (PooledIndex != INDEX_NONE) {
+		MaterialHits++;
+		UMaterialInstanceDynamic* DynamicMaterial = PooledMaterials[PooledIndex];
+		PooledMaterials.RemoveAt(PooledIndex);
+		return DynamicMaterial;
+	}
+	MaterialMisses++;
+	return UMaterialInstanceDynamic::Create(Parent, nullptr);
+}
+
+/**
+ * Takes back the texture of a tile that has left the catalog, dropping the oldest pooled textures beyond
+ * M_TILE_POOL_MAX_BYTES
+ * @param Texture Texture no longer used, ignored if nullptr
+ */
+void UMyTilePool::ReleaseTexture(UTexture2D* Texture) {
+	if (!Texture) {
+		return;
+	}
+	// The albedo is found by its file name when saving, and the maps are sampled as normals or masks
+	Texture->AssetImportData->SourceData.SourceFiles.Reset();
+	Texture->CompressionSettings = TC_Default;
+	
+	const int64 TextureBytes = Texture->CalcTextureMemorySizeEnum(TMC_AllMips);
+	PooledTextures.Add(Texture);
+	PooledBytes += TextureBytes;
+	FMyStats::TilePoolChanged(TextureBytes);
+	while (PooledBytes > M_TILE_POOL_MAX_BYTES) {
+		const int64 DroppedBytes = PooledTextures[0]->CalcTextureMemorySizeEnum(TMC_AllMips);
+		PooledTextures.RemoveAt(0);
+		PooledBytes -= DroppedBytes;
+		FMyStats::TilePoolChanged(-DroppedBytes);
+	}
+}
+
+/**
+ * Takes back the material instance of a tile that has left the catalog, dropping the oldest pooled material instances
+ * beyond M_TILE_POOL_MAX_MATERIALS
+ * @param DynamicMaterial Material instance no longer used by any wall, ignored if nullptr
+ */
+void UMyTilePool::ReleaseMaterial(UMaterialInstanceDynamic* DynamicMaterial) {
+	if (!DynamicMaterial) {
+		return;
+	}
+	DynamicMaterial->ClearParameterValues();
+	PooledMaterials.Add(DynamicMaterial);
+	if (PooledMaterials.Num() > M_TILE_POOL_MAX_MATERIALS) {
+		PooledMaterials.RemoveAt(0);
+	}
+}
+
+/**
+ * Uploads a mip into the GPU texture of a texture, on the render thread
+ * @param Texture Texture whose resource has been created
+ * @param MipIndex Mip to replace
+ * @param Mip Data of the mip, copied
+ */
+void UMyTilePool::UploadMip(UTexture2D* Texture, const int32 MipIndex, const FMyTextureMip& Mip) {
+	const FPixelFormatInfo& FormatInfo = GPixelFormats[Texture->GetPixelFormat()];
+	const uint32 Pitch = FMath::DivideAndRoundUp(Mip.Width, FormatInfo.BlockSizeX) * FormatInfo.BlockBytes;
+	uint8* Data = static_cast<uint8*>(FMemory::Malloc(Mip.Size));
+	FMemory::Memcpy(Data, Mip.Data, Mip.Size);
+	FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, Mip.Width, Mip.Height);
+	Texture->UpdateTextureRegions(MipIndex, 1, Region, Pitch, FormatInfo.BlockBytes, Data, [](uint8* SrcData, const FUpdateTextureRegion2D* Regions) {
+		FMemory::Free(SrcData);
+		delete Regions;
+	});
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyTilePool.generated.h"
+
+struct FImage;
+
+// Level of a texture's mip chain, as uploaded
+struct FMyTextureMip {
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	int32 Width = 0;
+	int32 Height = 0;
+};
+
+/**
+ * Recycles the transient textures and material instances of the tiles that leave the catalog. A released texture is
+ * reused by the next tile with the same size, format and mip count, its pixels uploaded into the existing GPU texture,
+ * and a released material instance by the next tile with the same parent material, its parameters cleared. Library
+ * churn then neither leaves garbage for the collector nor reallocates GPU memory. Pooled textures are capped at
+ * M_TILE_POOL_MAX_BYTES and material instances at M_TILE_POOL_MAX_MATERIALS, the oldest being dropped first. Hits and
+ * misses are reported in "stat MDVProject4" and in Insights
+ */
+UCLASS()
+class MDVPROJECT4_API UMyTilePool : public UWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	static UMyTilePool* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	UTexture2D* CreateTexture(const FImage& Image);
+
+	UTexture2D* CreateTexture(EPixelFormat PixelFormat, bool bSRGB, TConstArrayView<FMyTextureMip> Mips);
+
+	UMaterialInstanceDynamic* CreateMaterial(UMaterialInterface* Parent);
+
+	void ReleaseTexture(UTexture2D* Texture);
+
+	void ReleaseMaterial(UMaterialInstanceDynamic* DynamicMaterial);
+
+private:
+	// Oldest released first
+	UPROPERTY()
+	TArray<UTexture2D*> PooledTextures;
+
+	UPROPERTY()
+	TArray<UMaterialInstanceDynamic*> PooledMaterials;
+
+	int64 PooledBytes = 0;
+
+	uint32 TextureHits = 0;
+	uint32 TextureMisses = 0;
+	uint32 MaterialHits = 0;
+	uint32 MaterialMisses = 0;
+
+	static void UploadMip(UTexture2D* Texture, int32 MipIndex, const FMyTextureMip& Mip);
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyWorldRegistry.h"
+
+#include "AMyController.h"
+#include "MyReferenceManager.h"
+#include "MDVProject4/Objects/AMyActor.h"
+#include "MDVProject4/UI/HUD/MyHUD.h"
+
+
+/**
+ * Returns the registry of the world an object lives in
+ * @param WorldContextObject Any object of the world
+ * @return The registry, nullptr if the object is not in a world
+ */
+UMyWorldRegistry* UMyWorldRegistry::Get(const UObject* WorldContextObject) {
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UMyWorldRegistry>() : nullptr;
+}
+
+/**
+ * Registers one of the project's actors, called from their PostInitializeComponents so every actor of a level is known
+ * before any of them begins play. Walls are broadcast through OnWallAdded
+ * @param Actor Reference manager, controller, HUD, pawn or wall
+ */
+void UMyWorldRegistry::Register(AActor* Actor) {
+	if (AMyActor* Wall = Cast<AMyActor>(Actor)) {
+		bool bAlreadyRegistered = false;
+		Walls.Add(Wall, &bAlreadyRegistered);
+		if (!bAlreadyRegistered) {
+			if (Wall->Tags.IsValidIndex(1)) {
+				WallsByName.Add(Wall->Tags[1], Wall);
+			}
+			UpdateReferenceManager();
+			OnWallAdded.Broadcast(Wall);
+		}
+		return;
+	}
+	
+	if (AMyReferenceManager* NewReferenceManager = Cast<AMyReferenceManager>(Actor)) {
+		ReferenceManager = NewReferenceManager;
+	} else if (AMyController* NewController = Cast<AMyController>(Actor)) {
+		Controller = NewController;
+	} else if (AMyHUD* NewHUD = Cast<AMyHUD>(Actor)) {
+		HUD = NewHUD;
+	} else if (AMyPawn* NewPawn = Cast<AMyPawn>(Actor)) {
+		Pawn = NewPawn;
+	} else {
+		return;
+	}
+	UpdateReferenceManager();
+}
+
+/**
+ * Unregisters one of the project's actors, called from their EndPlay. Walls are broadcast through OnWallRemoved
+ * @param Actor Actor previously registered
+ */
+void UMyWorldRegistry::Unregister(AActor* Actor) {
+	if (AMyActor* Wall = Cast<AMyActor>(Actor)) {
+		if (Walls.Remove(Wall) > 0) {
+			if (Wall->Tags.IsValidIndex(1)) {
+				WallsByName.RemoveSingle(Wall->Tags[1], Wall);
+			}
+			UpdateReferenceManager();
+			OnWallRemoved.Broadcast(Wall);
+		}
+		return;
+	}
+	
+	if (Actor == ReferenceManager) {
+		ReferenceManager = nullptr;
+	} else if (Actor == Controller) {
+		Controller = nullptr;
+	} else if (Actor == HUD) {
+		HUD = nullptr;
+	} else if (Actor == Pawn) {
+		Pawn = nullptr;
+	} else {
+		return;
+	}
+	UpdateReferenceManager();
+}
+
+/**
+ * Finds a wall by its tag name
+ * @param WallName Second tag of the wall
+ * @return The wall, nullptr if none is registered with that name
+ */
+AMyActor* UMyWorldRegistry::FindWall(const FName WallName) const {
+	AMyActor* const* Wall = WallsByName.Find(WallName);
+	return Wall ? *Wall : nullptr;
+}
+
+/**
+ * Points the reference manager to the registered actors
+ */
+void UMyWorldRegistry::UpdateReferenceManager() const {
+	if (ReferenceManager) {
+		ReferenceManager->MyController = Controller;
+		ReferenceManager->MyHUD = HUD;
+		ReferenceManager->MyPawn = Pawn;
+		if (!ReferenceManager->MyActor || !Walls.Contains(ReferenceManager->MyActor)) {
+			ReferenceManager->MyActor = Walls.IsEmpty() ? nullptr : *Walls.CreateConstIterator();
+		}
+	}
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyWorldRegistry.generated.h"
+
+class AMyActor;
+class AMyController;
+class AMyHUD;
+class AMyPawn;
+class AMyReferenceManager;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnWallRegistryChanged, AMyActor* /*Wall*/);
+
+/**
+ * Keeps track of the project's actors as they are initialised and destroyed, so they can find each other without
+ * walking the world's actor list. The reference manager's pointers are kept up to date with the registered actors.
+ * Actors register from PostInitializeComponents(), so every actor of a level is known before any of them begins play
+ */
+UCLASS()
+class MDVPROJECT4_API UMyWorldRegistry : public UWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	static UMyWorldRegistry* Get(const UObject* WorldContextObject);
+
+	void Register(AActor* Actor);
+
+	void Unregister(AActor* Actor);
+
+	AMyReferenceManager* GetReferenceManager() const { return ReferenceManager; }
+
+	AMyController* GetController() const { return Controller; }
+
+	AMyHUD* GetHUD() const { return HUD; }
+
+	AMyPawn* GetPawn() const { return Pawn; }
+
+	const TSet<AMyActor*>& GetWalls() const { return Walls; }
+
+	AMyActor* FindWall(FName WallName) const;
+
+	FOnWallRegistryChanged OnWallAdded;
+
+	FOnWallRegistryChanged OnWallRemoved;
+
+private:
+	void UpdateReferenceManager() const;
+
+	UPROPERTY()
+	AMyReferenceManager* ReferenceManager;
+
+	UPROPERTY()
+	AMyController* Controller;
+
+	UPROPERTY()
+	AMyHUD* HUD;
+
+	UPROPERTY()
+	AMyPawn* Pawn;
+
+	UPROPERTY()
+	TSet<AMyActor*> Walls;
+
+	// Walls by tag name (their second tag)
+	UPROPERTY()
+	TMap<FName, AMyActor*> WallsByName;
+};
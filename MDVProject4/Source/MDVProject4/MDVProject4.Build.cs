@@ -8,9 +8,12 @@ public class MDVProject4 : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "ImageWrapper", "EnhancedInput", "DesktopPlatform", "SlateCore" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "ImageWrapper", "ImageCore", "EnhancedInput", "DesktopPlatform", "SlateCore" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] { "GameProjectGeneration", "GameProjectGeneration" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "GameProjectGeneration", "GameProjectGeneration", "Json" });
+
+		// Deflates screenshot stripes in parallel for the PNG encoder
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -3,8 +3,10 @@
 
 #include "AMyActor.h"
 
-#include "Kismet/GameplayStatics.h"
+#include "MDVProject4/Benchmark/MyInputRecorder.h"
 #include "MDVProject4/Controller/AMyController.h"
+#include "MDVProject4/Controller/MyAssetCache.h"
+#include "MDVProject4/Controller/MyWorldRegistry.h"
 #include "MDVProject4/Utils/Defines.h"
 
 // Sets default values
@@ -13,9 +15,6 @@ AMyActor::AMyActor() {
 	StaticMesh->SetupAttachment(RootComponent);
 
 	//GlowOverlayMat = LoadObject<UMaterialInstance>(nullptr, TEXT("/Script/Engine.MaterialInstanceConstant'/Game/Materials/MI_Glow.MI_Glow'"));
-
-	HorizontalStrippedOverlayMat = LoadObject<UMaterialInstance>(nullptr, TEXT("/Script/Engine.MaterialInstanceConstant'/Game/Materials/MI_StrippedHorizontal.MI_StrippedHorizontal'"));
-	VerticalStrippedOverlayMat = LoadObject<UMaterialInstance>(nullptr, TEXT("/Script/Engine.MaterialInstanceConstant'/Game/Materials/MI_StrippedVertical.MI_StrippedVertical'"));
 }
 
 // Called when the game starts or when spawned
@@ -23,7 +22,24 @@ void AMyActor::BeginPlay() {
 	Super::BeginPlay();
 	StaticMesh->SetMaterial(M_MAT_NUM, MaterialInterface);
 
-	MyReferenceManager = Cast<AMyReferenceManager>(UGameplayStatics::GetActorOfClass(GetWorld(), AMyReferenceManager::StaticClass()));
+	if (const UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		MyReferenceManager = Registry->GetReferenceManager();
+	}
+}
+
+void AMyActor::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Register(this);
+	}
+}
+
+// Called when the actor is destroyed or the level unloaded
+void AMyActor::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 
@@ -34,16 +50,22 @@ void AMyActor::Tick(float DeltaTime) {
 
 void AMyActor::WallSelected() {
 	if (MyReferenceManager->MyController->IsTileSelectEnabled()) {
-		MyReferenceManager->MyController->UpdateSelectedWall(this);
+		const bool bAdditive = MyReferenceManager->MyPawn->IsAdditiveSelectionHeld();
+		if (FMyInputRecorder::IsRecording() && Tags.IsValidIndex(1)) {
+			FMyInputRecorder::Record(EMyRecordedEventType::WallSelected, Tags[1].ToString(), bAdditive);
+		}
+		MyReferenceManager->MyController->UpdateSelectedWall(this, bAdditive);
 	}
 }
 
 void AMyActor::WallHovered() const {
 	if (MyReferenceManager->MyController->IsTileSelectEnabled()) {
-		if (IsHorizontalWall) {
-			StaticMesh->SetOverlayMaterial(HorizontalStrippedOverlayMat);
-		} else {
-			StaticMesh->SetOverlayMaterial(VerticalStrippedOverlayMat);
+		if (FMyInputRecorder::IsRecording() && Tags.IsValidIndex(1)) {
+			FMyInputRecorder::Record(EMyRecordedEventType::WallHovered, Tags[1].ToString());
+		}
+		// The overlays are shared by every wall and loaded once by the asset cache
+		if (const UMyAssetCache* AssetCache = UMyAssetCache::Get(this)) {
+			StaticMesh->SetOverlayMaterial(AssetCache->GetWallOverlay(IsHorizontalWall));
 		}
 		MyReferenceManager->MyController->WallHovered = true;
 		//StaticMesh->SetOverlayMaterial(GlowOverlayMat);
@@ -52,6 +74,9 @@ void AMyActor::WallHovered() const {
 
 void AMyActor::WallUnHovered() const {
 	if (MyReferenceManager->MyController->IsTileSelectEnabled()) {
+		if (FMyInputRecorder::IsRecording() && Tags.IsValidIndex(1)) {
+			FMyInputRecorder::Record(EMyRecordedEventType::WallUnHovered, Tags[1].ToString());
+		}
 		MyReferenceManager->MyController->WallHovered = false;
 		StaticMesh->SetOverlayMaterial(nullptr);
 	}
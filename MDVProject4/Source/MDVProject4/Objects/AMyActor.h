@@ -16,6 +16,8 @@ UCLASS()
 class MDVPROJECT4_API AMyActor : public AActor
 {
 	GENERATED_BODY()
+
+	friend class FMyInputRecorder;
 	
 public:	
 	// Sets default values for this actor's properties
@@ -40,6 +42,10 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void PostInitializeComponents() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 	UFUNCTION(BlueprintCallable)
 	void WallSelected();
@@ -56,12 +62,6 @@ private:
 	/*UPROPERTY()
 	UMaterialInstance* GlowOverlayMat;*/
 
-	UPROPERTY()
-	UMaterialInstance* HorizontalStrippedOverlayMat;
-
-	UPROPERTY()
-	UMaterialInstance* VerticalStrippedOverlayMat;
-
 	UPROPERTY(EditAnywhere, CallInEditor)
 	bool IsHorizontalWall;
 	
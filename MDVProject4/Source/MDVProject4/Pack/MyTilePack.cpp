@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyTilePack.h"
+
+#include "Async/MappedFileHandle.h"
+#include "Engine/Texture2D.h"
+#include "HAL/PlatformFileManager.h"
+#include "Serialization/MemoryReader.h"
+#include "MDVProject4/Controller/MyTilePool.h"
+#include "MDVProject4/Utils/Defines.h"
+
+
+FMyTilePack::~FMyTilePack() {
+	// The region must be released before the file it maps
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+/**
+ * Maps a pack and reads its index
+ * @param PackPath Path of the pack file
+ * @return The pack, nullptr if there is no pack or it cannot be read
+ */
+TSharedPtr<FMyTilePack> FMyTilePack::Open(const FString& PackPath) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*PackPath)) {
+		return nullptr;
+	}
+	
+	TSharedPtr<FMyTilePack> Pack(new FMyTilePack());
+	Pack->MappedFile.Reset(PlatformFile.OpenMapped(*PackPath));
+	Pack->MappedRegion.Reset(Pack->MappedFile ? Pack->MappedFile->MapRegion() : nullptr);
+	if (!Pack->MappedRegion) {
+		UE_LOG(LogTemp, Warning, TEXT("Could not map the tile pack %s"), *PackPath);
+		return nullptr;
+	}
+	
+	const TArrayView64<const uint8> PackData(Pack->MappedRegion->GetMappedPtr(), Pack->MappedRegion->GetMappedSize());
+	FMemoryReaderView Reader(PackData);
+	uint32 FileMagic = 0;
+	int32 FileVersion = 0;
+	int64 IndexOffset = 0;
+	Reader << FileMagic << FileVersion << IndexOffset;
+	if (FileMagic != Magic || FileVersion != Version || IndexOffset <= 0 || IndexOffset >= PackData.Num()) {
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a tile pack of version %d, it has to be packed again"), *PackPath, Version);
+		return nullptr;
+	}
+	Reader.Seek(IndexOffset);
+	Reader << Pack->Entries;
+	if (Reader.IsError()) {
+		UE_LOG(LogTemp, Warning, TEXT("The index of the tile pack %s is corrupted"), *PackPath);
+		return nullptr;
+	}
+	for (const FMyTilePackEntry& Entry : Pack->Entries) {
+		for (const FMyTilePackMip& Mip : Entry.Mips) {
+			if (Mip.Offset < 0 || Mip.Offset + Mip.Size > IndexOffset) {
+				UE_LOG(LogTemp, Warning, TEXT("The tile pack %s is truncated"), *PackPath);
+				return nullptr;
+			}
+		}
+	}
+	return Pack;
+}
+
+/**
+ * Writes a pack, the mip data of one entry at a time so the whole library never has to be held in memory
+ * @param PackPath Path of the pack file
+ * @param Entries Index entries, whose mip offsets are filled in
+ * @param GetMipData Called for each entry to get the BC1 data of its mips, described in the entry
+ * @return False if the file could not be written
+ */
+bool FMyTilePack::Write(const FString& PackPath, TArray<FMyTilePackEntry>& Entries, TFunctionRef<void(int32 EntryIndex, TArray<TArray<uint8>>& OutMips)> GetMipData) {
+	const FString TemporaryPath = PackPath + TEXT(".tmp");
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TemporaryPath));
+	if (!Writer) {
+		return false;
+	}
+	uint32 FileMagic = Magic;
+	int32 FileVersion = Version;
+	int64 IndexOffset = 0;
+	*Writer << FileMagic << FileVersion << IndexOffset;
+	
+	TArray<TArray<uint8>> MipData;
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); EntryIndex++) {
+		GetMipData(EntryIndex, MipData);
+		check(MipData.Num() == Entries[EntryIndex].Mips.Num());
+		for (int32 MipIndex = 0; MipIndex < MipData.Num(); MipIndex++) {
+			// Pad so every mip starts aligned in the mapped pages
+			static const uint8 Padding[M_PACK_ALIGNMENT] = {};
+			Writer->Serialize(const_cast<uint8*>(Padding), Align(Writer->Tell(), M_PACK_ALIGNMENT) - Writer->Tell());
+			FMyTilePackMip& Mip = Entries[EntryIndex].Mips[MipIndex];
+			Mip.Offset = Writer->Tell();
+			Mip.Size = MipData[MipIndex].Num();
+			Writer->Serialize(MipData[MipIndex].GetData(), Mip.Size);
+		}
+	}
+	
+	IndexOffset = Writer->Tell();
+	*Writer << Entries;
+	Writer->Seek(0);
+	*Writer << FileMagic << FileVersion << IndexOffset;
+	const bool bWritten = Writer->Close();
+	Writer.Reset();
+	
+	// Replace the previous pack only once the new one is complete
+	return bWritten && IFileManager::Get().Move(*PackPath, *TemporaryPath, true, true);
+}
+
+/**
+ * Creates a texture from the mips of a packed tile, copied from the mapped pages into the texture's platform data, or
+ * into a pooled texture of the same size
+ * @param TilePool Pool the texture is taken from when it holds one of the same size
+ * @param EntryIndex Index of the tile in GetEntries()
+ * @param FirstMip First mip to include, higher values give smaller textures
+ * @return The texture, nullptr if the entry has no mip
+ */
+UTexture2D* FMyTilePack::CreateTexture(UMyTilePool& TilePool, const int32 EntryIndex, const int32 FirstMip) const {
+	const FMyTilePackEntry& Entry = Entries[EntryIndex];
+	if (!Entry.Mips.IsValidIndex(FirstMip)) {
+		return nullptr;
+	}
+	const uint8* PackData = MappedRegion->GetMappedPtr();
+	
+	TArray<FMyTextureMip, TInlineAllocator<16>> Mips;
+	for (int32 MipIndex = FirstMip; MipIndex < Entry.Mips.Num(); MipIndex++) {
+		const FMyTilePackMip& PackMip = Entry.Mips[MipIndex];
+		Mips.Add({PackData + PackMip.Offset, PackMip.Size, PackMip.Width, PackMip.Height});
+	}
+	return TilePool.CreateTexture(PF_DXT1, true, Mips);
+}
+
+/**
+ * Returns the path of the pack of a tile library: next to its directory, with the same name
+ * @param LibraryDirectory Directory of the library, with or without trailing slash
+ * @return The pack path
+ */
+FString FMyTilePack::GetPackPath(const FString& LibraryDirectory) {
+	FString PackPath = LibraryDirectory;
+	PackPath.RemoveFromEnd(TEXT("/"));
+	return PackPath + TEXT(M_PACK_EXTENSION);
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MDVProject4/Utils/ColorSignature.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UTexture2D;
+class UMyTilePool;
+
+// Block compressed level of a packed tile's mip chain
+struct FMyTilePackMip {
+	int32 Width = 0;
+	int32 Height = 0;
+	int64 Offset = 0;
+	int64 Size = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FMyTilePackMip& Mip) {
+		return Ar << Mip.Width << Mip.Height << Mip.Offset << Mip.Size;
+	}
+};
+
+// Index entry of a packed tile, holding everything the catalog needs without reading the source file
+struct FMyTilePackEntry {
+	// Path of the source file relative to the packed library
+	FString FileName;
+	// Size and modification time of the source file, a loose file that differs from them replaces the packed tile
+	int64 FileSize = 0;
+	FDateTime Timestamp;
+	uint64 ContentHash = 0;
+	uint64 PerceptualHash = 0;
+	int64 PixelCount = 0;
+	FMyColorSignature ColorSignature;
+	// First mip no larger than M_PACK_THUMBNAIL_SIZE
+	int32 ThumbnailMip = 0;
+	TArray<FMyTilePackMip> Mips;
+
+	friend FArchive& operator<<(FArchive& Ar, FMyTilePackEntry& Entry) {
+		return Ar << Entry.FileName << Entry.FileSize << Entry.Timestamp << Entry.ContentHash << Entry.PerceptualHash
+			<< Entry.PixelCount << Entry.ColorSignature << Entry.ThumbnailMip << Entry.Mips;
+	}
+};
+
+/**
+ * Tile library packed in a single file by the MyTilePack commandlet: BC1 mip chains, capped at M_PACK_MAX_TILE_SIZE,
+ * followed by the index. The pack is memory mapped, so opening it only reads the index, and the textures are filled
+ * straight from the mapped pages of the mips, without decoding
+ * File layout: header (magic, version, index offset, entry count), mip data aligned to M_PACK_ALIGNMENT, index
+ */
+class MDVPROJECT4_API FMyTilePack {
+public:
+	~FMyTilePack();
+
+	static TSharedPtr<FMyTilePack> Open(const FString& PackPath);
+
+	static bool Write(const FString& PackPath, TArray<FMyTilePackEntry>& Entries, TFunctionRef<void(int32 EntryIndex, TArray<TArray<uint8>>& OutMips)> GetMipData);
+
+	const TArray<FMyTilePackEntry>& GetEntries() const { return Entries; }
+
+	UTexture2D* CreateTexture(UMyTilePool& TilePool, int32 EntryIndex, int32 FirstMip = 0) const;
+
+	static FString GetPackPath(const FString& LibraryDirectory);
+
+	static constexpr uint32 Magic = 0x5056444D; // "MDVP"
+	static constexpr int32 Version = 1;
+
+private:
+	FMyTilePack() = default;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<FMyTilePackEntry> Entries;
+};
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyTilePackCommandlet.h"
+
+#include "Async/ParallelFor.h"
+#include "MDVProject4/Controller/AMyController.h"
+#include "MDVProject4/Utils/Defines.h"
+#include "MDVProject4/Utils/ImageKernels.h"
+#include "MDVProject4/Utils/TileSetNaming.h"
+
+
+UMyTilePackCommandlet::UMyTilePackCommandlet() {
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+/**
+ * Packs the images of a library directory. Images are decoded, analysed and compressed in parallel by batches, each
+ * batch being written before the next is decoded. Tile sets with normal or roughness maps are left out, the pack only
+ * holding single image tiles
+ * @param Params Command line
+ * @return 0 on success, 1 if the pack could not be written
+ */
+int32 UMyTilePackCommandlet::Main(const FString& Params) {
+	FString SourceDirectory = FPaths::ProjectContentDir() + M_DIR_CONTENT_PATH;
+	FParse::Value(*Params, TEXT("Source="), SourceDirectory);
+	SourceDirectory = FPaths::ConvertRelativePathToFull(SourceDirectory) / TEXT("");
+	FString PackPath = FMyTilePack::GetPackPath(SourceDirectory);
+	FParse::Value(*Params, TEXT("Output="), PackPath);
+
+	// Same images as AMyController::InitialiseDynamicMaterialArray()
+	TArray<FString> FoundFiles;
+	IFileManager& FileManager = IFileManager::Get();
+	FileManager.FindFiles(FoundFiles, *SourceDirectory, *FString("png"));
+	FileManager.FindFiles(FoundFiles, *SourceDirectory, *FString("jpg"));
+	FileManager.FindFiles(FoundFiles, *SourceDirectory, *FString("jpeg"));
+	TArray<FString> PackedFiles;
+	for (const FMyTileSetFiles& TileSet : FMyTileSetNaming::Group(SourceDirectory, FoundFiles)) {
+		if (TileSet.HasMaps()) {
+			UE_LOG(LogTemp, Display, TEXT("%s has maps and is loaded from its files"), *FPaths::GetCleanFilename(TileSet.AlbedoPath));
+		} else {
+			PackedFiles.Add(FPaths::GetCleanFilename(TileSet.AlbedoPath));
+		}
+	}
+	FoundFiles = MoveTemp(PackedFiles);
+	UE_LOG(LogTemp, Display, TEXT("Packing %d tiles from %s into %s"), FoundFiles.Num(), *SourceDirectory, *PackPath);
+	
+	TArray<FMyTilePackEntry> Entries;
+	Entries.SetNum(FoundFiles.Num());
+	TArray<TArray<TArray<uint8>>> BatchMipData;
+	const bool bWritten = FMyTilePack::Write(PackPath, Entries, [&](const int32 EntryIndex, TArray<TArray<uint8>>& OutMips) {
+		if (EntryIndex % M_IMPORT_BATCH_SIZE == 0) {
+			const int32 BatchSize = FMath::Min(M_IMPORT_BATCH_SIZE, Entries.Num() - EntryIndex);
+			BatchMipData.Reset();
+			BatchMipData.SetNum(BatchSize);
+			ParallelFor(BatchSize, [&](const int32 BatchIndex) {
+				FMyTilePackEntry& Entry = Entries[EntryIndex + BatchIndex];
+				AMyController::FMyDecodedTile DecodedTile;
+				DecodedTile.FilePath = SourceDirectory + FoundFiles[EntryIndex + BatchIndex];
+				AMyController::DecodeTile(DecodedTile);
+				
+				Entry.FileName = FoundFiles[EntryIndex + BatchIndex];
+				Entry.FileSize = FileManager.FileSize(*DecodedTile.FilePath);
+				Entry.Timestamp = FileManager.GetTimeStamp(*DecodedTile.FilePath);
+				if (!DecodedTile.bDecoded) {
+					// Left without mips, so the loader falls back to the loose file
+					return;
+				}
+				Entry.ContentHash = DecodedTile.ContentHash;
+				Entry.PerceptualHash = DecodedTile.PerceptualHash;
+				Entry.PixelCount = DecodedTile.PixelCount;
+				Entry.ColorSignature = DecodedTile.ColorSignature;
+				BuildMips(DecodedTile.Image, Entry.Mips, BatchMipData[BatchIndex]);
+				Entry.ThumbnailMip = Entry.Mips.IndexOfByPredicate([](const FMyTilePackMip& Mip) {
+					return FMath::Max(Mip.Width, Mip.Height) <= M_PACK_THUMBNAIL_SIZE;
+				});
+			});
+		}
+		OutMips = MoveTemp(BatchMipData[EntryIndex % M_IMPORT_BATCH_SIZE]);
+	});
+	
+	if (!bWritten) {
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s"), *PackPath);
+		return 1;
+	}
+	for (const FMyTilePackEntry& Entry : Entries) {
+		if (Entry.Mips.IsEmpty()) {
+			UE_LOG(LogTemp, Warning, TEXT("%s could not be decoded and has not been packed"), *Entry.FileName);
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("Packed %d tiles into %s (%lld bytes)"), Entries.Num(), *PackPath, FileManager.FileSize(*PackPath));
+	return 0;
+}
+
+/**
+ * Builds the BC1 mip chain of an image: the first mip is shrunk to at most M_PACK_MAX_TILE_SIZE and cropped to whole
+ * blocks, each next mip halves the previous one, down to one pixel
+ * @param Image Decoded image
+ * @param OutMips Size of each mip, offsets are set when the pack is written
+ * @param OutMipData BC1 data of each mip
+ */
+void UMyTilePackCommandlet::BuildMips(const FImage& Image, TArray<FMyTilePackMip>& OutMips, TArray<TArray<uint8>>& OutMipData) {
+	FImage BGRAImage;
+	Image.CopyTo(BGRAImage, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+	const TArrayView64<FColor> Pixels = BGRAImage.AsBGRA8();
+	
+	TArray<FColor> MipPixels;
+	int32 Width, Height;
+	const int32 Factor = FMyImageKernels::GetDownsampleFactor(FMath::Max(BGRAImage.SizeX, BGRAImage.SizeY), M_PACK_MAX_TILE_SIZE);
+	FMyImageKernels::BoxDownsample(Pixels.GetData(), BGRAImage.SizeX, BGRAImage.SizeY, Factor, MipPixels, Width, Height);
+	
+	// Block compressed textures need a first mip made of whole blocks
+	const int32 CroppedWidth = Width >= 4 ? Width & ~3 : Width;
+	const int32 CroppedHeight = Height >= 4 ? Height & ~3 : Height;
+	if (CroppedWidth != Width || CroppedHeight != Height) {
+		TArray<FColor> CroppedPixels;
+		CroppedPixels.SetNumUninitialized(CroppedWidth * CroppedHeight);
+		for (int32 Y = 0; Y < CroppedHeight; Y++) {
+			FMemory::Memcpy(&CroppedPixels[Y * CroppedWidth], &MipPixels[Y * Width], CroppedWidth * sizeof(FColor));
+		}
+		MipPixels = MoveTemp(CroppedPixels);
+		Width = CroppedWidth;
+		Height = CroppedHeight;
+	}
+	
+	OutMips.Reset();
+	OutMipData.Reset();
+	while (true) {
+		FMyTilePackMip& Mip = OutMips.AddDefaulted_GetRef();
+		Mip.Width = Width;
+		Mip.Height = Height;
+		TArray<uint8>& MipData = OutMipData.AddDefaulted_GetRef();
+		MipData.SetNumUninitialized(FMyImageKernels::GetBC1Size(Width, Height));
+		FMyImageKernels::CompressBC1(MipPixels.GetData(), Width, Height, MipData.GetData());
+		if (Width == 1 && Height == 1) {
+			break;
+		}
+		TArray<FColor> NextPixels;
+		FMyImageKernels::BoxDownsample(MipPixels.GetData(), Width, Height, 2, NextPixels, Width, Height);
+		MipPixels = MoveTemp(NextPixels);
+	}
+}
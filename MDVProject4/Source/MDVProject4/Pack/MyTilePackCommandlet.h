@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageCore.h"
+#include "Commandlets/Commandlet.h"
+#include "MDVProject4/Pack/MyTilePack.h"
+
+#include "MyTilePackCommandlet.generated.h"
+
+
+/**
+ * Packs a tile library into a single file loaded at boot instead of the loose images (see FMyTilePack):
+ *   MDVProject4 -run=MyTilePack [-Source=<library directory>] [-Output=<pack file>]
+ * The library defaults to the game's tile resources and the pack to the file next to it
+ */
+UCLASS()
+class MDVPROJECT4_API UMyTilePackCommandlet : public UCommandlet {
+	GENERATED_BODY()
+
+public:
+	UMyTilePackCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	static void BuildMips(const FImage& Image, TArray<FMyTilePackMip>& OutMips, TArray<TArray<uint8>>& OutMipData);
+};
@@ -7,7 +7,10 @@
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
 #include "Blueprint/WidgetLayoutLibrary.h"
+#include "MDVProject4/Benchmark/MyInputRecorder.h"
 #include "MDVProject4/Controller/MyReferenceManager.h"
+#include "MDVProject4/Controller/MyWorldRegistry.h"
+#include "MDVProject4/Utils/Defines.h"
 
 // Sets default values
 AMyPawn::AMyPawn() {
@@ -18,7 +21,9 @@ AMyPawn::AMyPawn() {
 // Called when the game starts or when spawned
 void AMyPawn::BeginPlay() {
 	PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), 0);
-	MyReferenceManager = Cast<AMyReferenceManager>(UGameplayStatics::GetActorOfClass(GetWorld(), AMyReferenceManager::StaticClass()));
+	if (const UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		MyReferenceManager = Registry->GetReferenceManager();
+	}
 	
     if (PlayerController) {
         APlayerController* MyController = GetWorld()->GetFirstPlayerController();
@@ -36,12 +41,72 @@ void AMyPawn::BeginPlay() {
     }
 }
 
+void AMyPawn::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Register(this);
+	}
+}
+
+// Called when the actor is destroyed or the level unloaded
+void AMyPawn::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Handles a click on the screen, once released without having been dragged into a box selection
+ */
 void AMyPawn::OnClick() {
-	MyReferenceManager->MyController->ScreenClicked();
+	const bool bAdditive = IsAdditiveSelectionHeld();
+	FMyInputRecorder::Record(EMyRecordedEventType::ScreenClicked, FString(), bAdditive);
+	MyReferenceManager->MyController->ScreenClicked(bAdditive);
 	
 	UWidgetLayoutLibrary::GetMousePositionOnPlatform();
 }
 
+/**
+ * Stores where the click started so a drag can be turned into a box selection once released
+ */
+void AMyPawn::OnClickStarted() {
+	float MouseX, MouseY;
+	if (PlayerController && PlayerController->GetMousePosition(MouseX, MouseY)) {
+		ClickStartPosition = FVector2D(MouseX, MouseY);
+	} else {
+		ClickStartPosition = FVector2D(-1.f);
+	}
+}
+
+/**
+ * Triggers a box selection of the walls if the mouse has been dragged far enough since the click started, otherwise
+ * handles the click, so a drag does not also clear the selection as a click would
+ */
+void AMyPawn::OnClickCompleted() {
+	float MouseX, MouseY;
+	if (ClickStartPosition.X < 0.f || !PlayerController || !PlayerController->GetMousePosition(MouseX, MouseY)) {
+		OnClick();
+		return;
+	}
+	
+	const FVector2D ClickEndPosition(MouseX, MouseY);
+	if (FVector2D::Distance(ClickStartPosition, ClickEndPosition) < M_BOX_SELECT_MIN_DRAG) {
+		OnClick();
+	} else if (MyReferenceManager->MyController->IsTileSelectEnabled()) {
+		FMyInputRecorder::Record(EMyRecordedEventType::BoxSelect, FString(), IsAdditiveSelectionHeld(), ClickStartPosition, ClickEndPosition);
+		MyReferenceManager->MyController->SelectWallsInScreenBox(ClickStartPosition, ClickEndPosition, IsAdditiveSelectionHeld());
+	}
+}
+
+/**
+ * Checks if the user is holding shift, in which case wall selections add to the current one
+ * @return True if either shift key is held down
+ */
+bool AMyPawn::IsAdditiveSelectionHeld() const {
+	return PlayerController && (PlayerController->IsInputKeyDown(EKeys::LeftShift) || PlayerController->IsInputKeyDown(EKeys::RightShift));
+}
+
 // Called every frame
 void AMyPawn::Tick(float DeltaTime) {
 	Super::Tick(DeltaTime);
@@ -52,6 +117,7 @@ void AMyPawn::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
 
 	if (UEnhancedInputComponent* EnhancedInputComponent = CastChecked<UEnhancedInputComponent>(PlayerInputComponent)) {
-		EnhancedInputComponent->BindAction(ClickAction, ETriggerEvent::Triggered, this, &AMyPawn::OnClick);
+		EnhancedInputComponent->BindAction(ClickAction, ETriggerEvent::Started, this, &AMyPawn::OnClickStarted);
+		EnhancedInputComponent->BindAction(ClickAction, ETriggerEvent::Completed, this, &AMyPawn::OnClickCompleted);
 	}
 }
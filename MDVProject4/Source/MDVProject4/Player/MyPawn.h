@@ -21,6 +21,8 @@ public:
 
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
+
+	bool IsAdditiveSelectionHeld() const;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input)
 	UInputMappingContext* PawnMappingContext;
@@ -32,6 +34,10 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void PostInitializeComponents() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 	UPROPERTY()
 	APlayerController* PlayerController;
@@ -42,6 +48,12 @@ private:
 	UFUNCTION(BlueprintCallable)
 	void OnClick();
 
+	void OnClickStarted();
+
+	void OnClickCompleted();
+
+	FVector2D ClickStartPosition;
+
 	UPROPERTY()
 	AMyReferenceManager* MyReferenceManager;
 
@@ -5,14 +5,18 @@
 #include "Blueprint/UserWidget.h"
 #include "Kismet/GameplayStatics.h"
 #include "MDVProject4/Controller/MyReferenceManager.h"
+#include "MDVProject4/Controller/MyWorldRegistry.h"
 #include "IDesktopPlatform.h"
 #include "DesktopPlatformModule.h"
 #include "Engine/Texture2D.h"
 #include "MDVProject4/UI/Widgets/AlertDialog.h"
+#include "MDVProject4/Utils/Defines.h"
 
 
 void AMyHUD::BeginPlay() {
-	MyReferenceManager = Cast<AMyReferenceManager>(UGameplayStatics::GetActorOfClass(GetWorld(), AMyReferenceManager::StaticClass()));
+	if (const UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		MyReferenceManager = Registry->GetReferenceManager();
+	}
 	if (TileSelectWidget) {
 		// Create an object of class TileSelect if a blueprint has been set in the editor
 		TileSelect = CreateWidget<UTileSelect>(GetWorld(), TileSelectWidget);
@@ -28,9 +32,8 @@ void AMyHUD::BeginPlay() {
 		AlertDialog = CreateWidget<UAlertDialog>(GetWorld(), AlertDialogWidget);
 	}
 
-	if (NotifierWidget) {
-		Notifier = CreateWidget<UNotifier>(GetWorld(), NotifierWidget);
-	}
+	NotificationService = NewObject<UMyNotificationService>(this);
+	NotificationService->Initialise(NotifierWidget);
 
 	if (ScreenshotEffectWidget) {
 		ScreenshotEffect = CreateWidget<UScreenshotEffect>(GetWorld(), ScreenshotEffectWidget);
@@ -41,6 +44,24 @@ void AMyHUD::BeginPlay() {
 	}
 }
 
+void AMyHUD::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Register(this);
+	}
+}
+
+// Called when the actor is destroyed or the level unloaded
+void AMyHUD::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (NotificationService) {
+		NotificationService->Shutdown();
+	}
+	if (UMyWorldRegistry* Registry = UMyWorldRegistry::Get(this)) {
+		Registry->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
 /**
  * Notifies the controller that a user interaction has been performed to change a wall's material
  * @param DynamicMaterial The material that needs to be set on the wall, nullptr when the default material is desired
@@ -54,15 +75,33 @@ void AMyHUD::UpdateWallMaterial(UMaterialInstanceDynamic* DynamicMaterial) const
 }
 
 /**
- * Notifies the TileSelect widget that the SelectedWallTextBox needs to be updated with the wall's name
- * @param SelectedWall Wall that was selected (it contains the Wall name in a tag)
+ * Notifies the TileSelect widget that the SelectedWallTextBox needs to be updated with the walls' name
+ * @param SelectedWalls Walls that are selected (they contain the Wall name in a tag)
  */
-void AMyHUD::UpdateSelectedWallText(AMyActor* SelectedWall) const {
-	if (SelectedWall) {
-		TileSelect->UpdateText(SelectedWall->Tags[1].ToString());
-	}else {
+void AMyHUD::UpdateSelectedWallText(const TArray<AMyActor*>& SelectedWalls) const {
+	if (SelectedWalls.Num() == 1) {
+		TileSelect->UpdateText(SelectedWalls[0]->Tags[1].ToString());
+	} else if (SelectedWalls.Num() > 1) {
+		TileSelect->UpdateText(FText::Format(RetrieveDataTableMessage(WallsSelected), SelectedWalls.Num()).ToString());
+	} else {
 		TileSelect->UpdateText("-");
 	}
+	TileSelect->UpdateTileTransform(SelectedWalls.IsEmpty() ? FMyTileTransform() : MyReferenceManager->MyController->GetTileTransform(SelectedWalls[0]));
+}
+
+/**
+ * Notifies the controller that the selection must be extended to the groups of the selected walls
+ */
+void AMyHUD::SelectGroupPressed() const {
+	MyReferenceManager->MyController->SelectGroupOfSelectedWalls();
+}
+
+/**
+ * Notifies the controller that the tile transform of the selected walls has been edited
+ * @param TileTransform Scale, rotation, offset and grout of the tiles
+ */
+void AMyHUD::TileTransformChanged(const FMyTileTransform& TileTransform) const {
+	MyReferenceManager->MyController->SetTileTransform(TileTransform);
 }
 
 /**
@@ -72,6 +111,15 @@ void AMyHUD::RefreshTilesWidget(const TArray<FMyDynamicMat>& DynamicMaterialArra
 	TileSelect->RefreshWidget(DynamicMaterialArray);
 }
 
+/**
+ * Notifies the TileSelect widget that a tile's texture or material has changed since the widget was refreshed: its
+ * full resolution texture replaced its preview, or it has been loaded
+ * @param Tile Tile updated
+ */
+void AMyHUD::TileUpdated(const FMyDynamicMat& Tile) const {
+	TileSelect->UpdateTile(Tile);
+}
+
 /**
  * Notifies the controller that the Save button has been pressed
  */
@@ -105,45 +153,58 @@ void AMyHUD::DisplayScreenshotDialog() const {
 /**
  * Notifies the AlertDialog that it must be displayed with the missing files widgets
  * @param MissingFiles TMap <Material, Wall> containing the missing materials and their respective walls
+ * @param Replacements Tile each material remapped by name has been remapped to, for the user to confirm
  */
-void AMyHUD::DisplayMissingFilesDialog(const TMap<FString, FString>& MissingFiles) const {
+void AMyHUD::DisplayMissingFilesDialog(const TMap<FString, FString>& MissingFiles, const TMap<FString, FString>& Replacements) const {
 	if (AlertDialog) {
-		AlertDialog->PopulateWidget(MissingFiles);
+		AlertDialog->PopulateWidget(MissingFiles, Replacements);
 		AlertDialog->AddToViewport();
 	}
 }
 
 /**
- * Notifies the Notify that is must be displayed with the shared type and message
+ * Returns the tile last clicked on in the TileSelect widget
+ * @return The tile's CleanName, None if no tile has been clicked yet
+ */
+FName AMyHUD::GetLastClickedTile() const {
+	return TileSelect ? TileSelect->GetLastClickedTile() : NAME_None;
+}
+
+/**
+ * Notifies the controller that walls must display a tile, used to remap the walls of missing textures
+ * @param WallNames Tag names of the walls
+ * @param TileName CleanName of the tile
+ */
+void AMyHUD::RemapWalls(const TArray<FString>& WallNames, const FName TileName) const {
+	MyReferenceManager->MyController->RemapWalls(WallNames, TileName);
+}
+
+/**
+ * Looks for the tiles matching the query typed in the TileSelect widget
+ * @param Query Space separated terms
+ * @param OutTileIds TileIds of the matching tiles
+ */
+void AMyHUD::SearchTiles(const FString& Query, TArray<int32>& OutTileIds) const {
+	MyReferenceManager->MyController->SearchTiles(Query, OutTileIds);
+}
+
+/**
+ * Ranks the tiles by how close their colors are to the color picked in the TileSelect widget
+ * @param Color Picked color, linear
+ * @param OutTileIds TileIds of the tiles close to the color, closest first
+ */
+void AMyHUD::RankTilesByColor(const FLinearColor& Color, TArray<int32>& OutTileIds) const {
+	MyReferenceManager->MyController->RankTilesByColor(Color, OutTileIds);
+}
+
+/**
+ * Queues a notification with the shared type and message
  * @param NotifyType ENotifyType indicating the type of notification to display
  * @param Message The content of the notification
+ * @param Category Notifications of the same category are merged into one with a counter, without one identical messages are
  */
-void AMyHUD::Notify(const ENotifyType NotifyType, const FText& Message) const {
-	UTexture2D* Icon = nullptr;
-	switch (NotifyType){
-	case Info:
-		Icon = LoadObject<UTexture2D>(nullptr, TEXT("/Script/Engine.Texture2D'/Game/Resources/Icons/info.info'"));
-		break;
-		
-	case Warning:
-		Icon = LoadObject<UTexture2D>(nullptr, TEXT("/Script/Engine.Texture2D'/Game/Resources/Icons/Warning.Warning'"));
-		break;
-		
-	case Error:
-		Icon = LoadObject<UTexture2D>(nullptr, TEXT("/Script/Engine.Texture2D'/Game/Resources/Icons/Error.Error'"));
-		break;
-	}
-	
-	if (Icon) {
-		Notifier->SetIcon(Icon);
-	}
-
-	Notifier->SetMessageText(Message);
-	if (Notifier->IsInViewport()) {
-		Notifier->RemoveFromParent();	
-	}
-	Notifier->AddToViewport();
-	Notifier->PlayAnimation(Notifier->Anim, 0, 1);
+void AMyHUD::Notify(const ENotifyType NotifyType, const FText& Message, const FName Category) const {
+	NotificationService->Enqueue(NotifyType, Message, Category);
 }
 
 /**
@@ -158,6 +219,18 @@ void AMyHUD::TriggerScreenshotEffect(UTexture2D* ScreenshotTexture) const {
 	}
 }
 
+/**
+ * Called once a screenshot has been encoded and written to disk in the background
+ * @param Filename Path the screenshot was written to
+ * @param bSaved Whether the screenshot could be written
+ */
+void AMyHUD::ScreenshotSaved(const FString& Filename, const bool bSaved) const {
+	if (!bSaved) {
+		UE_LOG(LogTemp, Warning, TEXT("Could not save screenshot: %s"), *Filename);
+		Notify(Error, RetrieveDataTableMessage(FileSavedKO));
+	}
+}
+
 /**
  * Notifies the controller that it must create a screenshot, and re-enables input on the main (TileSelect) UI widget
  * @param ScreenshotName The name given to the screenshot by the user
@@ -203,11 +276,13 @@ void AMyHUD::ChangeResourcesDir() {
 	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
 	if (DesktopPlatform) {
 		void* ParentWindowHandle = GEngine->GameViewport->GetWindow()->GetNativeWindow()->GetOSWindowHandle();
-		FString Title = "ASD";
-		FString Path = "C:/Users/usuario/OneDrive/Documents/Unreal Projects/MDV/Project4";
+		FString Title = "Select the tile library";
+		FString Path = MyReferenceManager->MyController->LibraryRoots.IsEmpty() ? FPaths::ProjectContentDir() : MyReferenceManager->MyController->LibraryRoots[0];
     	
-		DesktopPlatform->OpenDirectoryDialog(ParentWindowHandle, Title, Path, FolderName);
-		UE_LOG(LogTemp, Warning, TEXT("File selected: %s"), *FolderName);
+		if (DesktopPlatform->OpenDirectoryDialog(ParentWindowHandle, Title, Path, FolderName)) {
+			UE_LOG(LogTemp, Display, TEXT("Library selected: %s"), *FolderName);
+			MyReferenceManager->MyController->MountLibraryRoots({FolderName});
+		}
 	}
 }
 
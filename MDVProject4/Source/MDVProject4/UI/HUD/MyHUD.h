@@ -6,7 +6,7 @@
 #include "GameFramework/HUD.h"
 #include "MDVProject4/Objects/AMyActor.h"
 #include "MDVProject4/UI/Widgets/AlertDialog.h"
-#include "MDVProject4/UI/Widgets/Notifier.h"
+#include "MDVProject4/UI/HUD/MyNotificationService.h"
 #include "MDVProject4/UI/Widgets/ScreenshotEffect.h"
 #include "MDVProject4/UI/Widgets/Settings.h"
 #include "MDVProject4/UI/Widgets/TileSelect.h"
@@ -24,12 +24,22 @@ class MDVPROJECT4_API AMyHUD : public AHUD
 
 public:
 	virtual void BeginPlay() override;
+
+	virtual void PostInitializeComponents() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	void UpdateWallMaterial(UMaterialInstanceDynamic* DynamicMaterial) const;
 	
-	void UpdateSelectedWallText(AMyActor* SelectedWall) const;
+	void UpdateSelectedWallText(const TArray<AMyActor*>& SelectedWalls) const;
+
+	void SelectGroupPressed() const;
+
+	void TileTransformChanged(const FMyTileTransform& TileTransform) const;
 	
 	void RefreshTilesWidget(const TArray<FMyDynamicMat>& DynamicMaterialArray) const;
+
+	void TileUpdated(const FMyDynamicMat& Tile) const;
 	
 	void SaveGameButtonPressed() const;
 	void LoadGameButtonPressed() const;
@@ -37,11 +47,21 @@ public:
 	
 	void DisplayScreenshotDialog() const;
 	
-	void DisplayMissingFilesDialog(const TMap<FString, FString>& MissingFiles) const;
+	void DisplayMissingFilesDialog(const TMap<FString, FString>& MissingFiles, const TMap<FString, FString>& Replacements) const;
+
+	FName GetLastClickedTile() const;
+
+	void RemapWalls(const TArray<FString>& WallNames, FName TileName) const;
+
+	void SearchTiles(const FString& Query, TArray<int32>& OutTileIds) const;
+
+	void RankTilesByColor(const FLinearColor& Color, TArray<int32>& OutTileIds) const;
 	
-	void Notify(ENotifyType NotifyType, const FText& Message) const;
+	void Notify(ENotifyType NotifyType, const FText& Message, FName Category = NAME_None) const;
 	
 	void TriggerScreenshotEffect(UTexture2D* ScreenshotTexture) const;
+
+	void ScreenshotSaved(const FString& Filename, bool bSaved) const;
 	
 	void ScreenshotNameSelected(const FText& ScreenshotName) const;
 	
@@ -90,20 +110,13 @@ private:
 	UAlertDialog* AlertDialog;
 	
 	UPROPERTY()
-	UNotifier* Notifier;
+	UMyNotificationService* NotificationService;
 
 	UPROPERTY()
 	UScreenshotEffect* ScreenshotEffect;
 
 	UPROPERTY()
 	USettings* Settings;
-	
-	UPROPERTY()
-	UTexture* InfoIcon;
-	UPROPERTY()
-	UTexture2D* WarningIcon;
-	UPROPERTY()
-	UTexture2D* ErrorIcon;
 
 	void DisableTileSelect() const;
 };
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyNotificationService.h"
+
+#include "MDVProject4/Controller/MyAssetCache.h"
+#include "MDVProject4/UI/Widgets/Notifier.h"
+#include "MDVProject4/Utils/Defines.h"
+
+
+/**
+ * Creates the widget pool, the widgets are added to the viewport once and hidden until they display something
+ * @param NotifierWidgetClass Notifier blueprint set on the HUD
+ */
+void UMyNotificationService::Initialise(const TSubclassOf<UUserWidget> NotifierWidgetClass) {
+	NotifierWidget = NotifierWidgetClass;
+	if (!NotifierWidget) {
+		return;
+	}
+	
+	for (int32 Index = 0; Index < M_NOTIFY_MAX_VISIBLE; Index++) {
+		if (UNotifier* Notifier = CreateWidget<UNotifier>(GetWorld(), NotifierWidget)) {
+			Notifier->OnNotifierFinished.BindUObject(this, &UMyNotificationService::NotifierFinished);
+			Notifier->SetVisibility(ESlateVisibility::Collapsed);
+			Notifier->AddToViewport();
+			FreeNotifiers.Add(Notifier);
+		}
+	}
+}
+
+void UMyNotificationService::Shutdown() {
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+	PendingNotifications.Reset();
+}
+
+/**
+ * Queues a notification, or merges it with a queued or displayed one of the same category
+ * @param NotifyType ENotifyType indicating the type of notification to display
+ * @param Message The content of the notification
+ * @param Category Notifications of the same category are merged, without one identical messages are
+ */
+void UMyNotificationService::Enqueue(const ENotifyType NotifyType, const FText& Message, const FName Category) {
+	// A displayed notification only has its counter updated, without restarting its animation
+	for (int32 Index = 0; Index < VisibleNotifications.Num(); Index++) {
+		FMyNotification& Notification = VisibleNotifications[Index];
+		if (Notification.Merges(NotifyType, Message, Category)) {
+			Notification.Message = Message;
+			Notification.Count++;
+			VisibleNotifiers[Index]->SetMessageText(GetDisplayText(Notification));
+			return;
+		}
+	}
+	
+	for (FMyNotification& Notification : PendingNotifications) {
+		if (Notification.Merges(NotifyType, Message, Category)) {
+			Notification.Message = Message;
+			Notification.Count++;
+			return;
+		}
+	}
+
+	// Errors go before warnings, and warnings before infos
+	int32 InsertIndex = PendingNotifications.Num();
+	while (InsertIndex > 0 && PendingNotifications[InsertIndex - 1].NotifyType < NotifyType) {
+		InsertIndex--;
+	}
+	PendingNotifications.Insert({NotifyType, Message, Category, 1}, InsertIndex);
+	if (PendingNotifications.Num() > M_NOTIFY_MAX_QUEUED) {
+		UE_LOG(LogTemp, Warning, TEXT("Notification dropped: %s"), *PendingNotifications.Last().Message.ToString());
+		PendingNotifications.Pop(false);
+	}
+	
+	if (!TickerHandle.IsValid()) {
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMyNotificationService::Tick));
+	}
+}
+
+/**
+ * Displays the next queued notification once a widget is free and the display interval has elapsed
+ * @return False once the queue is empty, which removes the ticker
+ */
+bool UMyNotificationService::Tick(float DeltaTime) {
+	const double Now = FPlatformTime::Seconds();
+	if (!FreeNotifiers.IsEmpty() && !PendingNotifications.IsEmpty() && Now - LastDisplayTime >= M_NOTIFY_MIN_INTERVAL) {
+		LastDisplayTime = Now;
+		Display(FreeNotifiers.Pop(false), PendingNotifications[0]);
+		PendingNotifications.RemoveAt(0, 1, false);
+	}
+	
+	if (PendingNotifications.IsEmpty()) {
+		TickerHandle.Reset();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Shows a pooled widget with the notification's icon and text and plays its animation
+ * @param Notifier Free widget of the pool
+ * @param Notification Notification to display
+ */
+void UMyNotificationService::Display(UNotifier* Notifier, const FMyNotification& Notification) {
+	const UMyAssetCache* AssetCache = UMyAssetCache::Get(this);
+	if (UTexture2D* Icon = AssetCache ? AssetCache->GetNotifyIcon(Notification.NotifyType) : nullptr) {
+		Notifier->SetIcon(Icon);
+	}
+	Notifier->SetMessageText(GetDisplayText(Notification));
+	Notifier->SetVisibility(ESlateVisibility::Visible);
+	Notifier->PlayAnimation(Notifier->Anim, 0, 1);
+	
+	VisibleNotifiers.Add(Notifier);
+	VisibleNotifications.Add(Notification);
+	StackVisibleNotifiers();
+}
+
+/**
+ * Returns a widget to the pool once its animation has finished or it has been clicked on
+ * @param Notifier Widget that has been hidden
+ */
+void UMyNotificationService::NotifierFinished(UNotifier* Notifier) {
+	const int32 Index = VisibleNotifiers.Find(Notifier);
+	if (Index == INDEX_NONE) {
+		return;
+	}
+	VisibleNotifiers.RemoveAt(Index);
+	VisibleNotifications.RemoveAt(Index);
+	FreeNotifiers.Add(Notifier);
+	StackVisibleNotifiers();
+	
+	if (!PendingNotifications.IsEmpty() && !TickerHandle.IsValid()) {
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMyNotificationService::Tick));
+	}
+}
+
+/**
+ * Offsets the displayed widgets so the newest one sits where the notifier is laid out and older ones stack below it
+ */
+void UMyNotificationService::StackVisibleNotifiers() {
+	float Offset = 0.f;
+	for (int32 Index = VisibleNotifiers.Num() - 1; Index >= 0; Index--) {
+		VisibleNotifiers[Index]->SetRenderTranslation(FVector2D(0.f, Offset));
+		Offset += VisibleNotifiers[Index]->GetDesiredSize().Y + M_NOTIFY_STACK_SPACING;
+	}
+}
+
+/**
+ * Returns the text to display for a notification, with the number of merged notifications if there is more than one
+ * @param Notification Notification to display
+ * @return The message, followed by "(xN)" for merged notifications
+ */
+FText UMyNotificationService::GetDisplayText(const FMyNotification& Notification) {
+	if (Notification.Count <= 1) {
+		return Notification.Message;
+	}
+	return FText::Format(INVTEXT("{0} (x{1})"), Notification.Message, FText::AsNumber(Notification.Count));
+}
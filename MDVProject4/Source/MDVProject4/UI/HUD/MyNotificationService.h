@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UObject/Object.h"
+#include "MDVProject4/Utils/DataStructures.h"
+#include "MyNotificationService.generated.h"
+
+class UNotifier;
+
+/**
+ * Queues notifications and displays them through a small pool of notifier widgets that stay in the viewport. Repeated
+ * notifications of the same category (or the same message) are merged into one with a counter, errors are displayed
+ * before warnings and infos, a new notification is displayed at most every M_NOTIFY_MIN_INTERVAL seconds and up to
+ * M_NOTIFY_MAX_VISIBLE are stacked on screen at once
+ */
+UCLASS()
+class MDVPROJECT4_API UMyNotificationService : public UObject {
+	GENERATED_BODY()
+
+public:
+	void Initialise(TSubclassOf<UUserWidget> NotifierWidgetClass);
+
+	void Shutdown();
+
+	void Enqueue(ENotifyType NotifyType, const FText& Message, FName Category = NAME_None);
+
+private:
+	struct FMyNotification {
+		TEnumAsByte<ENotifyType> NotifyType;
+		FText Message;
+		FName Category;
+		int32 Count;
+
+		bool Merges(const ENotifyType OtherType, const FText& OtherMessage, const FName OtherCategory) const {
+			return NotifyType == OtherType && (Category.IsNone() ? OtherCategory.IsNone() && Message.EqualTo(OtherMessage) : Category == OtherCategory);
+		}
+	};
+
+	bool Tick(float DeltaTime);
+
+	void Display(UNotifier* Notifier, const FMyNotification& Notification);
+
+	void NotifierFinished(UNotifier* Notifier);
+
+	void StackVisibleNotifiers();
+
+	static FText GetDisplayText(const FMyNotification& Notification);
+
+	UPROPERTY()
+	TSubclassOf<UUserWidget> NotifierWidget;
+
+	UPROPERTY()
+	TArray<UNotifier*> FreeNotifiers;
+
+	// Displayed widgets, from the oldest to the newest, and the notification each one displays
+	UPROPERTY()
+	TArray<UNotifier*> VisibleNotifiers;
+
+	TArray<FMyNotification> VisibleNotifications;
+
+	TArray<FMyNotification> PendingNotifications;
+
+	double LastDisplayTime = 0.0;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
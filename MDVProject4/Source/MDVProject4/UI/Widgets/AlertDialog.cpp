@@ -35,54 +35,71 @@ void UAlertDialog::AcceptButtonPressed() {
 	}
 }
 
-void UAlertDialog::PopulateWidget(TMap<FString, FString> MissingFiles) {
+/**
+ * Triggered when the Remap button is pressed on the widget. Applies the last tile clicked in the TileSelect widget to
+ * the walls of the selected texture, or to the walls of every texture that has not been remapped by name if none is
+ * selected
+ */
+void UAlertDialog::RemapButtonPressed() {
+	const FName TileName = MyHUD->GetLastClickedTile();
+	if (TileName.IsNone()) {
+		return;
+	}
+	
+	TArray<UMissingTextureItem*> RemappedItems;
+	if (UMissingTextureItem* SelectedItem = TreeView->GetSelectedItem<UMissingTextureItem>()) {
+		RemappedItems.Add(SelectedItem);
+	} else {
+		RemappedItems = MissingTextureItems.FilterByPredicate([](const UMissingTextureItem* Item) {
+			return Item->ReplacementName.IsEmpty();
+		});
+	}
+	
+	TArray<FString> WallNames;
+	for (UMissingTextureItem* Item : RemappedItems) {
+		WallNames.Append(Item->WallNames);
+		MissingTextureItems.RemoveSingle(Item);
+	}
+	MyHUD->RemapWalls(WallNames, TileName);
+	
+	if (MissingTextureItems.IsEmpty()) {
+		CloseButtonPressed();
+	} else {
+		TreeView->ClearSelection();
+		TreeView->SetListItems(MissingTextureItems);
+	}
+}
+
+/**
+ * Displays the walls whose texture could not be found or has been remapped by name, grouped by texture, so the user
+ * remaps the former and confirms or corrects the latter
+ * @param MissingFiles Tag name of each wall and the texture it was using
+ * @param Replacements Tile each texture remapped by name has been remapped to
+ */
+void UAlertDialog::PopulateWidget(const TMap<FString, FString>& MissingFiles, const TMap<FString, FString>& Replacements) {
 	Title->SetVisibility(ESlateVisibility::Visible);
 	MessageBody->SetText(MyHUD->RetrieveDataTableMessage(MissingTexturesMessage));
 	EditableText->SetVisibility(ESlateVisibility::Collapsed);
 	TreeView->SetVisibility(ESlateVisibility::Visible);
 	IncorrectNameText->SetVisibility(ESlateVisibility::Collapsed);
 	AcceptButton->SetVisibility(ESlateVisibility::Collapsed);
+	if (RemapButton) {
+		RemapButton->SetVisibility(ESlateVisibility::Visible);
+	}
 	
-	TArray<UTreeViewEntry*> TreeViewEntries;
-	
-	for (TPair<FString, FString>& Element : MissingFiles) {
-		bool Contains = false;
-		// Check if the TreeViewEntries already contains the texture source file. If so, add the wall as a children
-		if (!TreeViewEntries.IsEmpty()) {
-			for (UTreeViewEntry* TreeViewEntryElement : TreeViewEntries) {
-				if (Element.Value == TreeViewEntryElement->HeaderText->GetText().ToString()) {
-					Contains = true;
-					UTextBlock* NewBodyText = DuplicateObject<UTextBlock>(TreeViewEntryElement->BodyText, TreeViewEntryElement->BodyVerticalBox->GetOuter());
-					NewBodyText->SetText(FText::FromString(Element.Key));
-					TreeViewEntryElement->BodyVerticalBox->AddChild(NewBodyText);
-					break;
-				}
-			}
-		}
-		
-		if (!Contains) {
-			if (MyHUD->TreeViewEntryWidget) {
-				UTreeViewEntry* NewTreeViewEntry = CreateWidget<UTreeViewEntry>(GetWorld(), MyHUD->TreeViewEntryWidget);
-				NewTreeViewEntry->HeaderText->SetText(FText::FromString(Element.Value));
-				NewTreeViewEntry->BodyText->SetText(FText::FromString(Element.Key));
-				TreeViewEntries.Add(NewTreeViewEntry);
-			}
+	TMap<FString, UMissingTextureItem*> ItemsByTexture;
+	MissingTextureItems.Reset();
+	for (const TPair<FString, FString>& Element : MissingFiles) {
+		UMissingTextureItem*& Item = ItemsByTexture.FindOrAdd(Element.Value);
+		if (!Item) {
+			Item = NewObject<UMissingTextureItem>(this);
+			Item->TextureName = Element.Value;
+			Item->ReplacementName = Replacements.FindRef(Element.Value);
+			MissingTextureItems.Add(Item);
 		}
+		Item->WallNames.Add(Element.Key);
 	}
-
-	/*for (auto asd : TreeViewEntries) {
-		UE_LOG(LogTemp, Warning, TEXT("[pre] Header: %s"), *asd->HeaderText->GetText().ToString());
-	}
-
-	for (auto asd : TreeViewEntries) {
-		TreeView->AddItem(asd);
-	}*/
-	TreeView->SetListItems(TreeViewEntries);
-	//TreeView->SetSelectedItem(TreeViewEntries[0]);
-	
-	/*for (auto asd : TreeViewEntries) {
-		UE_LOG(LogTemp, Warning, TEXT("[post] Header: %s"), *asd->HeaderText->GetText().ToString());
-	}*/
+	TreeView->SetListItems(MissingTextureItems);
 }
 
 void UAlertDialog::PopulateWidget() {
@@ -92,4 +109,7 @@ void UAlertDialog::PopulateWidget() {
 	TreeView->SetVisibility(ESlateVisibility::Collapsed);
 	IncorrectNameText->SetVisibility(ESlateVisibility::Collapsed);
 	AcceptButton->SetVisibility(ESlateVisibility::Visible);
+	if (RemapButton) {
+		RemapButton->SetVisibility(ESlateVisibility::Collapsed);
+	}
 }
@@ -3,7 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "TreeViewEntry.h"
+#include "MissingTextureItem.h"
 #include "Blueprint/UserWidget.h"
 #include "Components/Button.h"
 #include "Components/EditableText.h"
@@ -29,6 +29,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void AcceptButtonPressed();
 
+	UFUNCTION(BlueprintCallable)
+	void RemapButtonPressed();
+
 	UPROPERTY(BlueprintReadWrite, meta=(BindWidget))
 	UTextBlock* Title;
 
@@ -50,14 +53,18 @@ public:
 	UPROPERTY(BlueprintReadWrite, meta=(BindWidget))
 	UTextBlock* IncorrectNameText;
 
+	// Remaps the walls of the selected missing texture, or of every missing texture, to the last clicked tile
+	UPROPERTY(BlueprintReadWrite, meta=(BindWidgetOptional))
+	UButton* RemapButton;
+
 	UPROPERTY()
 	AMyHUD* MyHUD;
 	
-	void PopulateWidget(TMap<FString, FString> MissingFiles);
+	void PopulateWidget(const TMap<FString, FString>& MissingFiles, const TMap<FString, FString>& Replacements);
 
 	void PopulateWidget();
 
 private:
 	UPROPERTY()
-	UTreeViewEntry* TreeViewEntry;
+	TArray<UMissingTextureItem*> MissingTextureItems;
 };
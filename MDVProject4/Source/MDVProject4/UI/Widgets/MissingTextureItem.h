@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "MissingTextureItem.generated.h"
+
+/**
+ * Row of the missing textures report: a texture that could not be found, or that has been remapped by name and waits
+ * for the user's confirmation, and the walls that were using it. Rows are plain data, the tree view only creates entry
+ * widgets for the rows on screen
+ */
+UCLASS()
+class MDVPROJECT4_API UMissingTextureItem : public UObject {
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	FString TextureName;
+
+	// Tile the walls have been remapped to by name, empty if the texture has not been remapped
+	UPROPERTY()
+	FString ReplacementName;
+
+	// Tag names of the walls
+	UPROPERTY()
+	TArray<FString> WallNames;
+};
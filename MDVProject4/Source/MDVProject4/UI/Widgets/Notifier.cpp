@@ -12,11 +12,21 @@ void UNotifier::NativeConstruct() {
 }
 
 void UNotifier::NotifyDelegateFunc() {
-	RemoveFromParent();
+	Hide();
 }
 
 void UNotifier::NotifyClicked() {
-	RemoveFromParent();
+	Hide();
+}
+
+/**
+ * Hides the notifier without removing it from the viewport, so it can be reused for the next notification
+ */
+void UNotifier::Hide() {
+	if (GetVisibility() != ESlateVisibility::Collapsed) {
+		SetVisibility(ESlateVisibility::Collapsed);
+		OnNotifierFinished.ExecuteIfBound(this);
+	}
 }
 
 void UNotifier::SetIcon(UTexture2D* IconTexture) {
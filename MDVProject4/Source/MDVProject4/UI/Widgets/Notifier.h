@@ -8,6 +8,10 @@
 #include "Components/TextBlock.h"
 #include "Notifier.generated.h"
 
+class UNotifier;
+
+DECLARE_DELEGATE_OneParam(FOnNotifierFinished, UNotifier* /*Notifier*/);
+
 /**
  * 
  */
@@ -27,6 +31,9 @@ public:
 	UWidgetAnimation* Anim;
 
 	FWidgetAnimationDynamicEvent Delegate;
+
+	// Executed when the notifier hides itself, once its animation has finished or it has been clicked on
+	FOnNotifierFinished OnNotifierFinished;
 	
 	virtual void NativeConstruct() override;
 		
@@ -39,4 +46,7 @@ public:
 	void SetIcon(UTexture2D* Icon);
 	
 	void SetMessageText(const FText& MessageText);
+
+private:
+	void Hide();
 };
@@ -6,18 +6,37 @@
 #include "MyButton.h"
 #include "Components/Image.h"
 #include "Components/Overlay.h"
+#include "Components/UniformGridSlot.h"
+#include "MDVProject4/Benchmark/MyInputRecorder.h"
 #include "MDVProject4/Controller/AMyController.h"
+#include "MDVProject4/Controller/MyFrameScheduler.h"
+#include "MDVProject4/Controller/MyTextureUploader.h"
 #include "MDVProject4/UI/HUD/MyHUD.h"
+#include "MDVProject4/Utils/MyLatencyTracker.h"
+#include "MDVProject4/Utils/MyStats.h"
 
 void UTileSelect::NativeOnInitialized() {
 	Super::NativeOnInitialized();
 	MyHUD = Cast<AMyHUD>(GetWorld()->GetFirstPlayerController()->GetHUD());
+	if (SearchText) {
+		SearchText->OnTextChanged.AddUniqueDynamic(this, &ThisClass::SearchTextChanged);
+	}
+	for (USpinBox* SpinBox : {ScaleSpinBox, RotationSpinBox, OffsetUSpinBox, OffsetVSpinBox, GroutWidthSpinBox}) {
+		if (SpinBox) {
+			SpinBox->OnValueCommitted.AddUniqueDynamic(this, &ThisClass::TileTransformValueCommitted);
+		}
+	}
+	if (UMyTextureUploader* TextureUploader = UMyTextureUploader::Get(this)) {
+		TextureUploader->OnGatherVisibleMaterials.AddUObject(this, &ThisClass::GatherVisibleMaterials);
+	}
 }
 
 /**
  * Triggered when the widget's "Default" button is pressed
  */
 void UTileSelect::DefaultPressed() const {
+	FMyInputRecorder::Record(EMyRecordedEventType::DefaultPressed);
+	FMyLatencyTracker::MarkClick();
 	MyHUD->UpdateWallMaterial(nullptr);
 }
 
@@ -25,6 +44,7 @@ void UTileSelect::DefaultPressed() const {
  * Triggered when the widget's "Save" button is pressed
  */
 void UTileSelect::SavePressed() const {
+	FMyInputRecorder::Record(EMyRecordedEventType::SavePressed);
 	MyHUD->SaveGameButtonPressed();
 }
 
@@ -32,6 +52,7 @@ void UTileSelect::SavePressed() const {
  * Triggered when the widget's "Load" button is pressed
  */
 void UTileSelect::LoadPressed() const {
+	FMyInputRecorder::Record(EMyRecordedEventType::LoadPressed);
 	MyHUD->LoadGameButtonPressed();
 }
 
@@ -39,6 +60,7 @@ void UTileSelect::LoadPressed() const {
  * Triggered when the widget's "Delete" button is pressed
  */
 void UTileSelect::DeletePressed() const {
+	FMyInputRecorder::Record(EMyRecordedEventType::DeletePressed);
 	MyHUD->DeleteButtonPressed();
 }
 
@@ -50,11 +72,11 @@ void UTileSelect::ScreenshotPressed() const {
 }
 
 /**
- * Sets the DynamicMaterialArray and makes calls to display it on screen
+ * Sets the DynamicMaterialArray and makes calls to display it on screen, one tile per group of near-duplicates
  * @param MyDynamicArray  Array containing the tile's information we must display
  */
 void UTileSelect::PopulateWidgets(TArray<FMyDynamicMat> MyDynamicArray) {
-	DynamicMaterialArray = MyDynamicArray;
+	DynamicMaterialArray = MyDynamicArray.FilterByPredicate([](const FMyDynamicMat& Element) { return Element.IsRepresentative(); });
 	GetBaseWidgets();
 	PopulateWidgetWithDynamicMaterialArray();
 }
@@ -70,38 +92,165 @@ void UTileSelect::GetBaseWidgets() {
 }
 
 /**
- * Iterates the DynamicMaterialArray extracting & parsing each tile's information to add them to the UniformGridPanel
+ * Iterates the DynamicMaterialArray extracting & parsing each tile's information to add them to the UniformGridPanel.
+ * The widgets are added by the frame scheduler, after the work that is visible on the walls, and filtered once all
+ * have been added
  */
 void UTileSelect::PopulateWidgetWithDynamicMaterialArray() {
 	UniformGridPanel->ClearChildren();
+	const uint32 Generation = ++PopulateGeneration;
+	UMyFrameScheduler* Scheduler = UMyFrameScheduler::Get(this);
+	for (int32 Index = 0; Index < DynamicMaterialArray.Num(); Index++) {
+		Scheduler->Submit(this, EMyWorkPriority::Low, [this, Generation, Index]() {
+			if (Generation == PopulateGeneration) {
+				AddTileWidget(Index);
+			}
+		});
+	}
+	Scheduler->Submit(this, EMyWorkPriority::Low, [this, Generation]() {
+		if (Generation == PopulateGeneration) {
+			ApplySearchFilter();
+		}
+	});
+}
+
+/**
+ * Adds the widget of a tile to the UniformGridPanel, after the widgets of the tiles before it
+ * @param Index Index of the tile in the DynamicMaterialArray
+ */
+void UTileSelect::AddTileWidget(const int32 Index) {
+	MDV_SCOPE_CYCLE_COUNTER(STAT_MDV_GridRebuild);
+	const FMyDynamicMat& Element = DynamicMaterialArray[Index];
+	// Duplicate the existing items, named by the engine as names of previous widgets may not have been collected yet
+	UOverlay* NewOverlay = DuplicateObject<UOverlay>(BaseOverlay, BaseOverlay->GetOuter());
+	UImage* Image = DuplicateObject<UImage>(BaseImage, BaseOverlay->GetOuter());
+	UOverlay* InternalOverlay = DuplicateObject<UOverlay>(BaseInternalOverlay, BaseOverlay->GetOuter());
+	UMyButton* Button = DuplicateObject<UMyButton>(BaseButton, InternalOverlay->GetOuter());
+
+	Button->OnClickedDelegate.AddUniqueDynamic(this, &ThisClass::OnMyButtonClicked);
+	
+	// Modify the duplicated items
+	Image->SetBrushFromTexture(Element.Texture2D, false);
+	
+	// Replace existing base items with the modified duplicated items
+	NewOverlay->ReplaceChild(BaseImage, Image);
+	NewOverlay->ReplaceChild(BaseInternalOverlay, InternalOverlay);
+	//NewOverlay->ReplaceChild(BaseButton, Button);
+	InternalOverlay->ClearChildren();
+	InternalOverlay->AddChild(Button);
+	
+	UniformGridPanel->AddChildToUniformGrid(NewOverlay, Index / 2, Index % 2);
+	// Laid out with the others once all have been added
+	if (!SearchQuery.IsEmpty() || SearchColorQuery.IsSet()) {
+		NewOverlay->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
+
+/**
+ * Adds the materials of the tiles shown in the visible part of the UniformGridPanel, whose uploads go first
+ * @param VisibleMaterials Materials on screen, gathered by the texture uploader
+ */
+void UTileSelect::GatherVisibleMaterials(TSet<const UMaterialInterface*>& VisibleMaterials) const {
+	if (!IsVisible()) {
+		return;
+	}
+	// The grid scrolls within its parent, which clips it
+	const UWidget* VisibleArea = UniformGridPanel->GetParent() ? UniformGridPanel->GetParent() : UniformGridPanel;
+	const FGeometry& AreaGeometry = VisibleArea->GetCachedGeometry();
+	const FSlateRect AreaRect = FSlateRect::FromPointAndExtent(AreaGeometry.GetAbsolutePosition(), AreaGeometry.GetAbsoluteSize());
+	const int32 TileCount = FMath::Min(UniformGridPanel->GetChildrenCount(), DynamicMaterialArray.Num());
+	for (int32 Index = 0; Index < TileCount; Index++) {
+		const UWidget* Tile = UniformGridPanel->GetChildAt(Index);
+		if (Tile->GetVisibility() == ESlateVisibility::Collapsed) {
+			continue;
+		}
+		const FGeometry& TileGeometry = Tile->GetCachedGeometry();
+		if (FSlateRect::DoRectanglesIntersect(AreaRect, FSlateRect::FromPointAndExtent(TileGeometry.GetAbsolutePosition(), TileGeometry.GetAbsoluteSize()))) {
+			VisibleMaterials.Add(DynamicMaterialArray[Index].DynamicMaterial);
+		}
+	}
+}
+
+/**
+ * Called on every keystroke in the search box
+ * @param Text Current content of the search box
+ */
+void UTileSelect::SearchTextChanged(const FText& Text) {
+	SearchQuery = Text.ToString().TrimStartAndEnd();
+	ApplySearchFilter();
+}
+
+/**
+ * Called when a color is picked to search tiles by
+ * @param Color Picked color, linear
+ */
+void UTileSelect::SearchColor(const FLinearColor Color) {
+	SearchColorQuery = Color;
+	ApplySearchFilter();
+}
+
+/**
+ * Goes back to showing the tiles in library order
+ */
+void UTileSelect::ClearColorSearch() {
+	SearchColorQuery.Reset();
+	ApplySearchFilter();
+}
+
+/**
+ * Shows only the tiles matching the SearchQuery and close to the SearchColorQuery, packed at the top of the
+ * UniformGridPanel, closest color first. The existing tile widgets are hidden and moved rather than rebuilt, so
+ * filtering costs the index lookups and one pass over the grid
+ */
+void UTileSelect::ApplySearchFilter() {
+	// The grid's children were added in DynamicMaterialArray order
+	const int32 TileCount = FMath::Min(UniformGridPanel->GetChildrenCount(), DynamicMaterialArray.Num());
+	TArray<int32> ShownTiles;
+	if (SearchColorQuery.IsSet() && MyHUD) {
+		TMap<int32, int32> TileIndices;
+		for (int32 Index = 0; Index < TileCount; Index++) {
+			TileIndices.Add(DynamicMaterialArray[Index].TileId, Index);
+		}
+		TArray<int32> TileIds;
+		MyHUD->RankTilesByColor(SearchColorQuery.GetValue(), TileIds);
+		for (const int32 TileId : TileIds) {
+			if (const int32* Index = TileIndices.Find(TileId)) {
+				ShownTiles.Add(*Index);
+			}
+		}
+	} else {
+		for (int32 Index = 0; Index < TileCount; Index++) {
+			ShownTiles.Add(Index);
+		}
+	}
+	
+	if (!SearchQuery.IsEmpty() && MyHUD) {
+		TArray<int32> TileIds;
+		MyHUD->SearchTiles(SearchQuery, TileIds);
+		const TSet<int32> MatchingTileIds(TileIds);
+		ShownTiles.RemoveAll([this, &MatchingTileIds](const int32 Index) {
+			return !MatchingTileIds.Contains(DynamicMaterialArray[Index].TileId);
+		});
+	}
+
+	for (int32 Index = 0; Index < TileCount; Index++) {
+		UniformGridPanel->GetChildAt(Index)->SetVisibility(ESlateVisibility::Collapsed);
+	}
 	int Row = 0, Column = 0;
-	for (FMyDynamicMat Element : DynamicMaterialArray) {
-    	// Duplicate the existing items
-    	UOverlay* NewOverlay = DuplicateObject<UOverlay>(BaseOverlay, BaseOverlay->GetOuter(), FName(Element.CleanName));
-    	UImage* Image = DuplicateObject<UImage>(BaseImage, BaseOverlay->GetOuter());
-    	UOverlay* InternalOverlay = DuplicateObject<UOverlay>(BaseInternalOverlay, BaseOverlay->GetOuter());
-    	UMyButton* Button = DuplicateObject<UMyButton>(BaseButton, InternalOverlay->GetOuter());
-
-    	Button->OnClickedDelegate.AddUniqueDynamic(this, &ThisClass::OnMyButtonClicked);
-    	
-    	// Modify the duplicated items
-    	Image->SetBrushFromTexture(Element.Texture2D, false);
-    	
-    	// Replace existing base items with the modified duplicated items
-    	NewOverlay->ReplaceChild(BaseImage, Image);
-    	NewOverlay->ReplaceChild(BaseInternalOverlay, InternalOverlay);
-    	//NewOverlay->ReplaceChild(BaseButton, Button);
-    	InternalOverlay->ClearChildren();
-    	InternalOverlay->AddChild(Button);
-    	
-    	UniformGridPanel->AddChildToUniformGrid(NewOverlay, Row, Column);
-    	if (Column == 1) {
-    		Row++;
-    		Column = 0;
-    	} else {
-    		Column++;
-    	}
-    }
+	for (const int32 Index : ShownTiles) {
+		UWidget* Tile = UniformGridPanel->GetChildAt(Index);
+		Tile->SetVisibility(ESlateVisibility::Visible);
+		if (UUniformGridSlot* GridSlot = Cast<UUniformGridSlot>(Tile->Slot)) {
+			GridSlot->SetRow(Row);
+			GridSlot->SetColumn(Column);
+		}
+		if (Column == 1) {
+			Row++;
+			Column = 0;
+		} else {
+			Column++;
+		}
+	}
 }
 
 /**
@@ -109,12 +258,16 @@ void UTileSelect::PopulateWidgetWithDynamicMaterialArray() {
  * @param Button Which button has been clicked
  */
 void UTileSelect::OnMyButtonClicked(UMyButton* Button) {
-	for (const FMyDynamicMat Element : DynamicMaterialArray) {
-		if (Element.CleanName == FName(Button->GetParent()->GetParent()->GetName())) {
-			MyHUD->UpdateWallMaterial(Element.DynamicMaterial);
-			break;
-		}
+	// The grid's children were added in DynamicMaterialArray order
+	const int32 Index = UniformGridPanel->GetChildIndex(Button->GetParent()->GetParent());
+	if (!DynamicMaterialArray.IsValidIndex(Index)) {
+		return;
 	}
+	const FMyDynamicMat& Element = DynamicMaterialArray[Index];
+	FMyInputRecorder::Record(EMyRecordedEventType::TileClicked, Element.CleanName.ToString());
+	FMyLatencyTracker::MarkClick();
+	LastClickedTile = Element.CleanName;
+	MyHUD->UpdateWallMaterial(Element.DynamicMaterial);
 }
 
 void UTileSelect::UpdateText(const FString& WallName) {
@@ -124,18 +277,120 @@ void UTileSelect::UpdateText(const FString& WallName) {
 }
 
 /**
- * Refreshed the DynamicMaterialArray data and makes a call to redraw the widget's UniformGridPanel
+ * Displays the tile transform of the selected walls
+ * @param WallTileTransform Tile transform of the first selected wall
+ */
+void UTileSelect::UpdateTileTransform(const FMyTileTransform& WallTileTransform) {
+	TileTransform = WallTileTransform;
+	if (ScaleSpinBox) {
+		ScaleSpinBox->SetValue(TileTransform.Scale);
+	}
+	if (RotationSpinBox) {
+		RotationSpinBox->SetValue(TileTransform.Rotation);
+	}
+	if (OffsetUSpinBox) {
+		OffsetUSpinBox->SetValue(TileTransform.Offset.X);
+	}
+	if (OffsetVSpinBox) {
+		OffsetVSpinBox->SetValue(TileTransform.Offset.Y);
+	}
+	if (GroutWidthSpinBox) {
+		GroutWidthSpinBox->SetValue(TileTransform.GroutWidth);
+	}
+}
+
+/**
+ * Triggered when a value of the tile transform spin boxes is committed, applies all of them to the selected walls
+ * @param Value Committed value
+ * @param CommitMethod How the value was committed
+ */
+void UTileSelect::TileTransformValueCommitted(float Value, ETextCommit::Type CommitMethod) {
+	FMyTileTransform NewTileTransform = TileTransform;
+	if (ScaleSpinBox) {
+		NewTileTransform.Scale = ScaleSpinBox->GetValue();
+	}
+	if (RotationSpinBox) {
+		NewTileTransform.Rotation = RotationSpinBox->GetValue();
+	}
+	if (OffsetUSpinBox) {
+		NewTileTransform.Offset.X = OffsetUSpinBox->GetValue();
+	}
+	if (OffsetVSpinBox) {
+		NewTileTransform.Offset.Y = OffsetVSpinBox->GetValue();
+	}
+	if (GroutWidthSpinBox) {
+		NewTileTransform.GroutWidth = GroutWidthSpinBox->GetValue();
+	}
+	SetTileTransform(NewTileTransform);
+}
+
+/**
+ * Applies a tile transform to the selected walls
+ * @param NewTileTransform Scale, rotation, offset and grout of the tiles
+ */
+void UTileSelect::SetTileTransform(const FMyTileTransform NewTileTransform) {
+	TileTransform = NewTileTransform;
+	if (FMyInputRecorder::IsRecording()) {
+		FString ExportedTileTransform;
+		FMyTileTransform::StaticStruct()->ExportText(ExportedTileTransform, &TileTransform, nullptr, nullptr, PPF_None, nullptr);
+		FMyInputRecorder::Record(EMyRecordedEventType::TileTransformChanged, ExportedTileTransform);
+	}
+	MyHUD->TileTransformChanged(TileTransform);
+}
+
+/**
+ * Sets the grout color of the selected walls, for a color picker of the layout
+ * @param GroutColor Grout color, linear
+ */
+void UTileSelect::SetGroutColor(const FLinearColor GroutColor) {
+	FMyTileTransform NewTileTransform = TileTransform;
+	NewTileTransform.GroutColor = GroutColor;
+	SetTileTransform(NewTileTransform);
+}
+
+/**
+ * Refreshed the DynamicMaterialArray data, one tile per group of near-duplicates, and makes a call to redraw the
+ * widget's UniformGridPanel
  * @param MyDynamicArray Array containing the new set of data that needs to be displayed
  */
 void UTileSelect::RefreshWidget(const TArray<FMyDynamicMat> MyDynamicArray) {
-	DynamicMaterialArray = MyDynamicArray;
+	DynamicMaterialArray = MyDynamicArray.FilterByPredicate([](const FMyDynamicMat& Element) { return Element.IsRepresentative(); });
 	PopulateWidgetWithDynamicMaterialArray();
 }
 
+/**
+ * Shows the current texture of a tile and applies its current material when clicked
+ * @param Tile Tile whose texture or material has changed
+ */
+void UTileSelect::UpdateTile(const FMyDynamicMat& Tile) {
+	const int32 Index = DynamicMaterialArray.IndexOfByPredicate([&Tile](const FMyDynamicMat& Element) {
+		return Element.TileId == Tile.TileId;
+	});
+	if (Index == INDEX_NONE) {
+		return;
+	}
+	// Widgets not added yet are created from the array
+	DynamicMaterialArray[Index].Texture2D = Tile.Texture2D;
+	DynamicMaterialArray[Index].DynamicMaterial = Tile.DynamicMaterial;
+	if (Index < UniformGridPanel->GetChildrenCount()) {
+		if (UImage* Image = Cast<UImage>(Cast<UOverlay>(UniformGridPanel->GetChildAt(Index))->GetChildAt(0))) {
+			Image->SetBrushFromTexture(Tile.Texture2D, false);
+		}
+	}
+}
+
 void UTileSelect::SettingsPressed() const {
 	MyHUD->SettingsPressed();
 }
 
+/**
+ * Triggered when the widget's "Select group" button is pressed
+ */
+void UTileSelect::SelectGroupPressed() const {
+	FMyInputRecorder::Record(EMyRecordedEventType::SelectGroupPressed);
+	MyHUD->SelectGroupPressed();
+}
+
 void UTileSelect::Disable() {
 	SetVisibility(ESlateVisibility::HitTestInvisible);
 }
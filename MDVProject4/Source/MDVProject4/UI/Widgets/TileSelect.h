@@ -5,8 +5,10 @@
 #include "CoreMinimal.h"
 #include "MyButton.h"
 #include "Blueprint/UserWidget.h"
+#include "Components/EditableText.h"
 #include "Components/Image.h"
 #include "Components/Overlay.h"
+#include "Components/SpinBox.h"
 #include "Components/TextBlock.h"
 #include "Components/UniformGridPanel.h"
 #include "MDVProject4/Utils/DataStructures.h"
@@ -29,11 +31,17 @@ public:
 	
 	void RefreshWidget(const TArray<FMyDynamicMat> MyDynamicArray);
 
+	void UpdateTile(const FMyDynamicMat& Tile);
+
 	void UpdateText(const FString& WallName);
 
+	void UpdateTileTransform(const FMyTileTransform& WallTileTransform);
+
 	void Disable();
 	void Enable();
 
+	FName GetLastClickedTile() const { return LastClickedTile; }
+
 	UPROPERTY(BlueprintReadWrite, meta=(BindWidget))
 	UTextBlock* SelectedWallTextBox;
 	
@@ -46,6 +54,26 @@ public:
 	UPROPERTY(BlueprintReadWrite, meta=(BindWidget))
 	UButton* Settings;
 
+	// Filters the tiles as the user types, optional so layouts without a search box keep working
+	UPROPERTY(BlueprintReadWrite, meta=(BindWidgetOptional))
+	UEditableText* SearchText;
+
+	// Edit the tile transform of the selected walls, optional so layouts without them keep working
+	UPROPERTY(BlueprintReadWrite, meta=(BindWidgetOptional))
+	USpinBox* ScaleSpinBox;
+
+	UPROPERTY(BlueprintReadWrite, meta=(BindWidgetOptional))
+	USpinBox* RotationSpinBox;
+
+	UPROPERTY(BlueprintReadWrite, meta=(BindWidgetOptional))
+	USpinBox* OffsetUSpinBox;
+
+	UPROPERTY(BlueprintReadWrite, meta=(BindWidgetOptional))
+	USpinBox* OffsetVSpinBox;
+
+	UPROPERTY(BlueprintReadWrite, meta=(BindWidgetOptional))
+	USpinBox* GroutWidthSpinBox;
+
 private:
 	UFUNCTION(BlueprintCallable)
 	void DefaultPressed() const;
@@ -65,11 +93,43 @@ private:
 	UFUNCTION(BlueprintCallable)
 	void SettingsPressed() const;
 
+	UFUNCTION(BlueprintCallable)
+	void SelectGroupPressed() const;
+
 	UFUNCTION()
 	void OnMyButtonClicked(UMyButton* Button);
+
+	UFUNCTION()
+	void SearchTextChanged(const FText& Text);
+
+	// Shows only the tiles close to a color, closest first, combined with the text search
+	UFUNCTION(BlueprintCallable)
+	void SearchColor(FLinearColor Color);
+
+	UFUNCTION(BlueprintCallable)
+	void ClearColorSearch();
+
+	UFUNCTION()
+	void TileTransformValueCommitted(float Value, ETextCommit::Type CommitMethod);
+
+	// Applies a tile transform to the selected walls, for layouts editing it with their own widgets
+	UFUNCTION(BlueprintCallable)
+	void SetTileTransform(FMyTileTransform NewTileTransform);
+
+	UFUNCTION(BlueprintCallable)
+	void SetGroutColor(FLinearColor GroutColor);
+
+	UFUNCTION(BlueprintPure)
+	FMyTileTransform GetTileTransform() const { return TileTransform; }
 	
 	void PopulateWidgetWithDynamicMaterialArray();
 
+	void AddTileWidget(int32 Index);
+
+	void GatherVisibleMaterials(TSet<const UMaterialInterface*>& VisibleMaterials) const;
+
+	void ApplySearchFilter();
+
 	void GetBaseWidgets();
 
 	UPROPERTY()
@@ -78,6 +138,18 @@ private:
 	UPROPERTY()
 	TArray<FMyDynamicMat> DynamicMaterialArray;
 
+	FName LastClickedTile;
+
+	// Changes with every population of the grid, so widgets scheduled for a previous one are not added
+	uint32 PopulateGeneration = 0;
+
+	FString SearchQuery;
+
+	TOptional<FLinearColor> SearchColorQuery;
+
+	// Tile transform of the first selected wall, as displayed and edited
+	FMyTileTransform TileTransform;
+
 	UPROPERTY()
 	UImage* BaseImage;
 	UPROPERTY()
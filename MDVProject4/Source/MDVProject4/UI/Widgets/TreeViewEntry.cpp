@@ -1,22 +1,25 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "MDVProject4/UI/Widgets/TreeViewEntry.h"
+#include "MDVProject4/UI/Widgets/MissingTextureItem.h"
 
 
+/**
+ * Displays a missing texture, the tile it has been remapped to if any, and its walls. Entry widgets are recycled by the tree view as it scrolls, so this only
+ * sets the texts of the existing children
+ * @param ListItemObject UMissingTextureItem to display
+ */
 void UTreeViewEntry::NativeOnListItemObjectSet(UObject* ListItemObject) {
 	IUserObjectListEntry::NativeOnListItemObjectSet(ListItemObject);
 	
-	UTreeViewEntry* TreeViewEntry = Cast<UTreeViewEntry>(ListItemObject);
-	UE_LOG(LogTemp, Warning, TEXT("Working on %s"), *TreeViewEntry->HeaderText->GetText().ToString());
-	HeaderText->SetText(TreeViewEntry->HeaderText->GetText());
-	//HeaderText = TreeViewEntry->HeaderText;
-	
-	BodyVerticalBox->ClearChildren();
-	for (UWidget* Child : TreeViewEntry->BodyVerticalBox->GetAllChildren()) {
-		UTextBlock* ChildBodyText = Cast<UTextBlock>(Child);
-		UTextBlock* NewBodyText = DuplicateObject<UTextBlock>(ChildBodyText, TreeViewEntry->BodyVerticalBox->GetOuter());
-		NewBodyText->SetText(ChildBodyText->GetText());
-		BodyVerticalBox->AddChild(NewBodyText);
+	const UMissingTextureItem* Item = Cast<UMissingTextureItem>(ListItemObject);
+	if (!Item) {
+		return;
+	}
+	if (Item->ReplacementName.IsEmpty()) {
+		HeaderText->SetText(FText::Format(INVTEXT("{0} ({1})"), FText::FromString(Item->TextureName), FText::AsNumber(Item->WallNames.Num())));
+	} else {
+		HeaderText->SetText(FText::Format(INVTEXT("{0} -> {1} ({2})"), FText::FromString(Item->TextureName), FText::FromString(Item->ReplacementName), FText::AsNumber(Item->WallNames.Num())));
 	}
-	//BodyVerticalBox = TreeViewEntry->BodyVerticalBox;
+	BodyText->SetText(FText::FromString(FString::Join(Item->WallNames, TEXT("\n"))));
 }
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ColorSignature.h"
+
+#include "MDVProject4/Utils/ImageKernels.h"
+
+
+/**
+ * Computes the signature of an image: its pixels are sorted into the histogram cells, whose mean colors make up the
+ * palette. Meant for images already shrunk with FMyImageKernels::BoxDownsample(). Safe to call from worker threads
+ * @param Pixels Pixels of the image, in sRGB
+ * @param Width Image width
+ * @param Height Image height
+ * @return The signature, invalid if the image is empty
+ */
+FMyColorSignature FMyColorSignature::Compute(const FColor* Pixels, const int32 Width, const int32 Height) {
+	FMyColorSignature Signature;
+	if (!Pixels || Width <= 0 || Height <= 0) {
+		return Signature;
+	}
+	
+	TArray<FVector4f> BinSums;
+	TArray<int32> BinCounts;
+	FMyImageKernels::BinColors(Pixels, static_cast<int64>(Width) * Height, M_COLOR_HISTOGRAM_LEVELS, BinSums, BinCounts);
+
+	// Bin sums are in memory order: B, G, R, A
+	auto BinMean = [&BinSums, &BinCounts](const int32 Bin) {
+		const FVector4f& Sum = BinSums[Bin];
+		const float Count = BinCounts[Bin];
+		return FColor(FMath::RoundToInt(Sum.Z / Count), FMath::RoundToInt(Sum.Y / Count), FMath::RoundToInt(Sum.X / Count));
+	};
+	
+	TArray<int32> Bins;
+	FVector4f TotalSum = FVector4f::Zero();
+	int32 MaxCount = 0;
+	for (int32 Bin = 0; Bin < M_COLOR_HISTOGRAM_BINS; Bin++) {
+		if (BinCounts[Bin] > 0) {
+			Bins.Add(Bin);
+			TotalSum += BinSums[Bin];
+			MaxCount = FMath::Max(MaxCount, BinCounts[Bin]);
+		}
+	}
+	const float PixelCount = static_cast<float>(Width) * Height;
+	Signature.MeanLab = ToLab(FLinearColor(FColor(
+		FMath::RoundToInt(TotalSum.Z / PixelCount), FMath::RoundToInt(TotalSum.Y / PixelCount), FMath::RoundToInt(TotalSum.X / PixelCount))));
+	
+	for (const int32 Bin : Bins) {
+		Signature.Histogram[Bin] = static_cast<uint8>(FMath::DivideAndRoundNearest(BinCounts[Bin] * 255, MaxCount));
+	}
+	
+	Bins.Sort([&BinCounts](const int32 A, const int32 B) { return BinCounts[A] > BinCounts[B]; });
+	for (int32 Index = 0; Index < M_COLOR_PALETTE_SIZE && Index < Bins.Num(); Index++) {
+		Signature.Palette[Index] = ToLab(FLinearColor(BinMean(Bins[Index])));
+		Signature.PaletteWeights[Index] = BinCounts[Bins[Index]] / PixelCount;
+	}
+	Signature.bValid = true;
+	return Signature;
+}
+
+/**
+ * Perceptual distance between the tile and a color: the distance to the closest dominant color, increased the less of
+ * the tile that color covers, so tiles mostly of the queried color come first
+ * @param QueryLab Queried color, in Lab
+ * @return The distance, in Lab units
+ */
+float FMyColorSignature::GetDistance(const FVector3f& QueryLab) const {
+	float Distance = MAX_flt;
+	for (int32 Index = 0; Index < M_COLOR_PALETTE_SIZE; Index++) {
+		if (PaletteWeights[Index] > 0.f) {
+			Distance = FMath::Min(Distance, FVector3f::Dist(Palette[Index], QueryLab) + M_COLOR_COVERAGE_PENALTY * (1.f - PaletteWeights[Index]));
+		}
+	}
+	return Distance;
+}
+
+/**
+ * Difference between the histograms of two tiles, the share of their cells they do not have in common
+ * @param Other Signature of the other tile
+ * @return 0 for identical histograms, up to 1 for histograms without a cell in common
+ */
+float FMyColorSignature::GetHistogramDistance(const FMyColorSignature& Other) const {
+	int32 Difference = 0;
+	int32 Total = 0;
+	for (int32 Index = 0; Index < M_COLOR_HISTOGRAM_BINS; Index++) {
+		Difference += FMath::Abs(Histogram[Index] - Other.Histogram[Index]);
+		Total += FMath::Max(Histogram[Index], Other.Histogram[Index]);
+	}
+	return Total > 0 ? static_cast<float>(Difference) / Total : 0.f;
+}
+
+/**
+ * Converts a linear color to CIE Lab, D65 white point
+ * @param LinearColor Color in linear sRGB
+ * @return L in [0, 100], a and b roughly in [-128, 127]
+ */
+FVector3f FMyColorSignature::ToLab(const FLinearColor& LinearColor) {
+	const float X = (0.4124f * LinearColor.R + 0.3576f * LinearColor.G + 0.1805f * LinearColor.B) / 0.95047f;
+	const float Y = 0.2126f * LinearColor.R + 0.7152f * LinearColor.G + 0.0722f * LinearColor.B;
+	const float Z = (0.0193f * LinearColor.R + 0.1192f * LinearColor.G + 0.9505f * LinearColor.B) / 1.08883f;
+	auto F = [](const float T) {
+		return T > 0.008856f ? FMath::Pow(T, 1.f / 3.f) : 7.787f * T + 16.f / 116.f;
+	};
+	const float FX = F(X), FY = F(Y), FZ = F(Z);
+	return FVector3f(116.f * FY - 16.f, 500.f * (FX - FY), 200.f * (FY - FZ));
+}
+
+/**
+ * Serialises a signature, used by tile packs
+ * @param Ar Archive to read from or write to
+ * @param Signature Signature to serialise
+ * @return The archive
+ */
+FArchive& operator<<(FArchive& Ar, FMyColorSignature& Signature) {
+	Ar << Signature.MeanLab;
+	for (int32 Index = 0; Index < M_COLOR_PALETTE_SIZE; Index++) {
+		Ar << Signature.Palette[Index] << Signature.PaletteWeights[Index];
+	}
+	for (int32 Index = 0; Index < M_COLOR_HISTOGRAM_BINS; Index++) {
+		Ar << Signature.Histogram[Index];
+	}
+	Ar << Signature.bValid;
+	return Ar;
+}
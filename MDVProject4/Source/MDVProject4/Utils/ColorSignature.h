@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MDVProject4/Utils/Defines.h"
+
+/**
+ * Compact description of the colors of a tile, compared in CIE Lab so distances follow perceived differences:
+ * - The mean color of the tile
+ * - Its dominant colors with the share of the tile each covers
+ * - A coarse RGB histogram, each cell scaled so the fullest one is 255
+ */
+struct MDVPROJECT4_API FMyColorSignature {
+	FVector3f MeanLab = FVector3f::ZeroVector;
+
+	TStaticArray<FVector3f, M_COLOR_PALETTE_SIZE> Palette = TStaticArray<FVector3f, M_COLOR_PALETTE_SIZE>(InPlace, FVector3f::ZeroVector);
+
+	TStaticArray<float, M_COLOR_PALETTE_SIZE> PaletteWeights = TStaticArray<float, M_COLOR_PALETTE_SIZE>(InPlace, 0.f);
+
+	TStaticArray<uint8, M_COLOR_HISTOGRAM_BINS> Histogram = TStaticArray<uint8, M_COLOR_HISTOGRAM_BINS>(InPlace, 0);
+
+	bool bValid = false;
+
+	static FMyColorSignature Compute(const FColor* Pixels, int32 Width, int32 Height);
+
+	float GetDistance(const FVector3f& QueryLab) const;
+
+	float GetHistogramDistance(const FMyColorSignature& Other) const;
+
+	static FVector3f ToLab(const FLinearColor& LinearColor);
+
+	friend FArchive& operator<<(FArchive& Ar, FMyColorSignature& Signature);
+};
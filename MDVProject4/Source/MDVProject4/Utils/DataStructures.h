@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Engine/DataTable.h"
+#include "MDVProject4/Utils/ColorSignature.h"
 #include "DataStructures.generated.h"
 
+class FMyTilePack;
 
 USTRUCT()
 struct FMyDynamicMat {
@@ -20,11 +22,62 @@ struct FMyDynamicMat {
 	UPROPERTY()
 	UMaterialInstanceDynamic* DynamicMaterial;
 
+	// Normal and roughness/AO maps of the tile set, bound to the same material. Empty paths for a single image tile
+	UPROPERTY()
+	FString NormalPath;
+
+	UPROPERTY()
+	FString RoughnessPath;
+
+	UPROPERTY()
+	UTexture2D* NormalTexture;
+
+	UPROPERTY()
+	UTexture2D* RoughnessTexture;
+
+	// Hash of the source file's content, used to find the tile again after it has been renamed or moved
+	UPROPERTY()
+	uint64 ContentHash;
+
+	// Identifier that stays the same while other tiles are added or removed, used by the search index
+	UPROPERTY()
+	int32 TileId;
+
+	// Colors of the tile, used to search the library by color
+	FMyColorSignature ColorSignature;
+
+	// Difference hash of the tile, close for re-exports of the same image at other resolutions or qualities
+	UPROPERTY()
+	uint64 PerceptualHash;
+
+	UPROPERTY()
+	int64 PixelCount;
+
+	// TileId of the tile shown in the picker for this tile and its near-duplicates, the only one loaded until used
+	UPROPERTY()
+	int32 RepresentativeId;
+
+	// Pack the tile is loaded from and its entry in it, nullptr for a tile loaded from its image file
+	TSharedPtr<FMyTilePack> TilePack;
+	int32 PackEntry;
+
 	FMyDynamicMat() {
 		CleanName = "NoName";
 		Path = "NoPath";
 		Texture2D = nullptr;
 		DynamicMaterial = nullptr;
+		NormalTexture = nullptr;
+		RoughnessTexture = nullptr;
+		ContentHash = 0;
+		TileId = INDEX_NONE;
+		PerceptualHash = 0;
+		PixelCount = 0;
+		RepresentativeId = INDEX_NONE;
+		PackEntry = INDEX_NONE;
+	}
+
+	bool IsRepresentative() const {
+		return RepresentativeId == TileId;
 	}
 
 	bool operator==(const FMyDynamicMat MyDynamicMat) const {
@@ -36,6 +89,49 @@ struct FMyDynamicMat {
 };
 
 
+// Placement of a tile on a wall and the grout between tiles. Sent to BaseMaterial as custom primitive data of the wall,
+// so walls showing the same tile keep sharing its material instance
+USTRUCT(BlueprintType)
+struct FMyTileTransform {
+	GENERATED_BODY()
+
+	// Tiles per texture repeat, above 1 for smaller tiles
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Scale;
+
+	// Rotation of the tiles, in degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Rotation;
+
+	// Offset of the tiles, in texture repeats
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D Offset;
+
+	// Width of the grout lines as a fraction of a tile, 0 for none
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float GroutWidth;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FLinearColor GroutColor;
+
+	FMyTileTransform() {
+		Scale = 1.f;
+		Rotation = 0.f;
+		Offset = FVector2D::ZeroVector;
+		GroutWidth = 0.f;
+		GroutColor = FLinearColor(0.8f, 0.8f, 0.8f);
+	}
+
+	bool operator==(const FMyTileTransform& Other) const {
+		return Scale == Other.Scale
+		&& Rotation == Other.Rotation
+		&& Offset == Other.Offset
+		&& GroutWidth == Other.GroutWidth
+		&& GroutColor == Other.GroutColor;
+	}
+};
+
+
 UENUM()
 enum ENotifyType {
 	Info = 0,
@@ -73,4 +169,38 @@ enum EDataTableContentIndex {
 	MissingTexturesMessage	= 11,
 	ScreenshotNameMessage	= 12,
 	IncorrectScreenshotName	= 13,
+	// "{0} walls have been remapped to renamed or moved textures."
+	TexturesRemapped		= 14,
+	// "{0} tiles have been mounted, {1} walls have been remapped to them."
+	LibraryMounted			= 15,
+	// "{0} walls"
+	WallsSelected			= 16,
+	DataTableContentCount	UMETA(Hidden)
+};
+
+
+UENUM(BlueprintType)
+enum EScreenshotFormat {
+	ScreenshotPNG	= 0,
+	ScreenshotJPEG	= 1,
+	ScreenshotQOI	= 2,
+	ScreenshotRaw	= 3,
+};
+
+
+USTRUCT(BlueprintType)
+struct FScreenshotEncodeSettings {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TEnumAsByte<EScreenshotFormat> Format;
+
+	// PNG: zlib compression level (0 = zlib's default, 1 = uncompressed, up to 9). JPEG: quality from 1 to 100. Ignored otherwise
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Quality;
+
+	FScreenshotEncodeSettings() {
+		Format = ScreenshotPNG;
+		Quality = 0;
+	}
 };
@@ -1,6 +1,5 @@
 #pragma once
 
-#define FILE_SAVED_KO "Error saving file. Please try again."
 #define FILE_LOADED_KO "Error loading file. Please try again."
 
 #define CONTENT_DIR = "/Resources/TileResources/"
@@ -9,4 +8,48 @@
 #define M_DIR_CONTENT_PATH "Resources/TileResources/"
 #define M_SAVE_SLOT_NAME "MySlot"
 #define M_SAVE_SLOT_NUM 0
-#define M_MAT_NUM 0
\ No newline at end of file
+#define M_MAT_NUM 0
+
+// Custom primitive data of the selection highlight, 1 when selected. The wall materials (their default material and
+// the tiles' BaseMaterial) must read it to show the highlight
+#define M_CPD_SELECTED 0
+// Custom primitive data of the tile transform: scale, rotation, offset U and V, then grout width and color
+#define M_CPD_TILE_TRANSFORM 1
+#define M_CPD_GROUT 5
+#define M_BOX_SELECT_MIN_DRAG 8.f
+
+#define M_SCREENSHOT_PREVIEW_MAX_WIDTH 480
+
+#define M_NOTIFY_MAX_VISIBLE 3
+#define M_NOTIFY_MAX_QUEUED 16
+#define M_NOTIFY_MIN_INTERVAL 0.25
+#define M_NOTIFY_STACK_SPACING 8.f
+// Notification categories, a burst of notifications of one category shows as its latest one with a counter
+#define M_NOTIFY_CATEGORY_LIBRARY "Library"
+#define M_NOTIFY_CATEGORY_SAVE_GAME "SaveGame"
+
+#define M_TILE_ANALYSIS_SIZE 64
+#define M_COLOR_HISTOGRAM_LEVELS 4
+#define M_COLOR_HISTOGRAM_BINS (M_COLOR_HISTOGRAM_LEVELS * M_COLOR_HISTOGRAM_LEVELS * M_COLOR_HISTOGRAM_LEVELS)
+#define M_COLOR_PALETTE_SIZE 4
+#define M_COLOR_COVERAGE_PENALTY 20.f
+#define M_COLOR_SEARCH_MAX_DISTANCE 30.f
+#define M_IMPORT_BATCH_SIZE 32
+
+#define M_DUPLICATE_MAX_HASH_DISTANCE 6
+#define M_DUPLICATE_MAX_COLOR_DISTANCE 6.f
+// Tiles whose hash has fewer bits set are flat or low-contrast, and only grouped with tiles of nearly the same colors
+#define M_DUPLICATE_MIN_HASH_BITS 8
+#define M_DUPLICATE_MAX_FLAT_COLOR_DISTANCE 1.f
+#define M_DUPLICATE_MAX_FLAT_HISTOGRAM_DISTANCE 0.1f
+
+#define M_PACK_EXTENSION ".mdvpack"
+#define M_PACK_MAX_TILE_SIZE 1024
+#define M_PACK_THUMBNAIL_SIZE 128
+#define M_PACK_ALIGNMENT 16
+
+// Textures and material instances kept for reuse by the tile pool
+#define M_TILE_POOL_MAX_BYTES (64ll * 1024 * 1024)
+#define M_TILE_POOL_MAX_MATERIALS 256
+// Tiles of a replaced library released per frame scheduler work item
+#define M_TILE_RELEASE_BATCH_SIZE 16
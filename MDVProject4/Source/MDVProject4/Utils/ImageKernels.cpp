@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImageKernels.h"
+
+#include "Async/ParallelFor.h"
+
+
+/**
+ * Downsamples an image by averaging every Factor x Factor block of pixels into one. The four channels of a pixel are
+ * processed at once in a vector register, and output rows are spread across worker threads
+ * @param Source Source pixels
+ * @param SourceWidth Source width
+ * @param SourceHeight Source height
+ * @param Factor Size of the averaged blocks, 1 copies the image
+ * @param OutPixels Downsampled pixels, opaque
+ * @param OutWidth Downsampled width (SourceWidth / Factor, rounded down)
+ * @param OutHeight Downsampled height (SourceHeight / Factor, rounded down)
+ */
+void FMyImageKernels::BoxDownsample(const FColor* Source, const int32 SourceWidth, const int32 SourceHeight, const int32 Factor, TArray<FColor>& OutPixels, int32& OutWidth, int32& OutHeight) {
+	check(Factor > 0);
+	OutWidth = FMath::Max(SourceWidth / Factor, 1);
+	OutHeight = FMath::Max(SourceHeight / Factor, 1);
+	OutPixels.SetNumUninitialized(OutWidth * OutHeight);
+	
+	const int32 BlockWidth = FMath::Min(Factor, SourceWidth);
+	const int32 BlockHeight = FMath::Min(Factor, SourceHeight);
+	FColor* Destination = OutPixels.GetData();
+	const int32 DestinationWidth = OutWidth;
+	
+	ParallelFor(OutHeight, [Source, SourceWidth, BlockWidth, BlockHeight, Destination, DestinationWidth](const int32 OutY) {
+		const VectorRegister4Float Scale = VectorSetFloat1(1.f / (BlockWidth * BlockHeight));
+		// Rounds to nearest, VectorStoreByte4 truncates
+		const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+		
+		for (int32 OutX = 0; OutX < DestinationWidth; OutX++) {
+			VectorRegister4Float Sum = VectorZeroFloat();
+			const FColor* BlockStart = Source + static_cast<int64>(OutY) * BlockHeight * SourceWidth + OutX * BlockWidth;
+			for (int32 Y = 0; Y < BlockHeight; Y++) {
+				const FColor* Row = BlockStart + static_cast<int64>(Y) * SourceWidth;
+				for (int32 X = 0; X < BlockWidth; X++) {
+					Sum = VectorAdd(Sum, VectorLoadByte4(Row + X));
+				}
+			}
+			FColor& OutPixel = Destination[OutY * DestinationWidth + OutX];
+			VectorStoreByte4(VectorMultiplyAdd(Sum, Scale, Half), &OutPixel);
+			OutPixel.A = 255;
+		}
+	});
+}
+
+/**
+ * Returns the smallest integer downsample factor that brings an image within a maximum width
+ * @param SourceWidth Source width
+ * @param MaxWidth Maximum downsampled width
+ * @return The downsample factor, at least 1
+ */
+int32 FMyImageKernels::GetDownsampleFactor(const int32 SourceWidth, const int32 MaxWidth) {
+	return FMath::Max(FMath::DivideAndRoundUp(SourceWidth, FMath::Max(MaxWidth, 1)), 1);
+}
+
+/**
+ * Computes the difference hash (dHash) of an image: the image is averaged down to 9 x 8 grey cells and each bit tells
+ * whether a cell is brighter than its right neighbour. Re-exports of an image at another resolution or compression
+ * give hashes a few bits apart. Meant for images already shrunk with BoxDownsample()
+ * @param Pixels Pixels of the image
+ * @param Width Image width
+ * @param Height Image height
+ * @return The 64 bit hash, 0 for an empty image
+ */
+uint64 FMyImageKernels::ComputeDifferenceHash(const FColor* Pixels, const int32 Width, const int32 Height) {
+	if (!Pixels || Width <= 0 || Height <= 0) {
+		return 0;
+	}
+	constexpr int32 CellsX = 9, CellsY = 8;
+	float Cells[CellsY][CellsX];
+	for (int32 CellY = 0; CellY < CellsY; CellY++) {
+		const int32 StartY = CellY * Height / CellsY;
+		const int32 EndY = FMath::Max((CellY + 1) * Height / CellsY, StartY + 1);
+		for (int32 CellX = 0; CellX < CellsX; CellX++) {
+			const int32 StartX = CellX * Width / CellsX;
+			const int32 EndX = FMath::Max((CellX + 1) * Width / CellsX, StartX + 1);
+			float Sum = 0.f;
+			for (int32 Y = StartY; Y < EndY; Y++) {
+				for (int32 X = StartX; X < EndX; X++) {
+					const FColor& Pixel = Pixels[Y * Width + X];
+					Sum += 0.299f * Pixel.R + 0.587f * Pixel.G + 0.114f * Pixel.B;
+				}
+			}
+			Cells[CellY][CellX] = Sum / ((EndY - StartY) * (EndX - StartX));
+		}
+	}
+	
+	uint64 Hash = 0;
+	for (int32 CellY = 0; CellY < CellsY; CellY++) {
+		for (int32 CellX = 0; CellX < CellsX - 1; CellX++) {
+			Hash = Hash << 1 | (Cells[CellY][CellX] > Cells[CellY][CellX + 1] ? 1 : 0);
+		}
+	}
+	return Hash;
+}
+
+/**
+ * Block compresses an opaque image to BC1 (DXT1). Each 4 x 4 block gets the corners of its color bounding box, inset
+ * by a sixteenth to reduce the error on outliers, and every pixel the closest of the four interpolated colors. Blocks
+ * overlapping the edges repeat the last row and column. Fast rather than optimal, meant for offline packing
+ * @param Pixels Pixels of the image
+ * @param Width Image width
+ * @param Height Image height
+ * @param OutBlocks Compressed blocks, GetBC1Size() bytes, row by row
+ */
+void FMyImageKernels::CompressBC1(const FColor* Pixels, const int32 Width, const int32 Height, uint8* OutBlocks) {
+	const int32 BlocksX = FMath::DivideAndRoundUp(Width, 4);
+	const int32 BlocksY = FMath::DivideAndRoundUp(Height, 4);
+	
+	ParallelFor(BlocksY, [Pixels, Width, Height, BlocksX, OutBlocks](const int32 BlockY) {
+		auto To565 = [](const int32 R, const int32 G, const int32 B) {
+			return static_cast<uint16>((R >> 3) << 11 | (G >> 2) << 5 | B >> 3);
+		};
+		auto From565 = [](const uint16 Color) {
+			const int32 R = Color >> 11 & 31, G = Color >> 5 & 63, B = Color & 31;
+			return FIntVector(R << 3 | R >> 2, G << 2 | G >> 4, B << 3 | B >> 2);
+		};
+		
+		for (int32 BlockX = 0; BlockX < BlocksX; BlockX++) {
+			FColor Block[16];
+			for (int32 Y = 0; Y < 4; Y++) {
+				for (int32 X = 0; X < 4; X++) {
+					Block[Y * 4 + X] = Pixels[FMath::Min(BlockY * 4 + Y, Height - 1) * Width + FMath::Min(BlockX * 4 + X, Width - 1)];
+				}
+			}
+			
+			FIntVector Min(255, 255, 255), Max(0, 0, 0);
+			for (const FColor& Pixel : Block) {
+				Min = FIntVector(FMath::Min(Min.X, static_cast<int32>(Pixel.R)), FMath::Min(Min.Y, static_cast<int32>(Pixel.G)), FMath::Min(Min.Z, static_cast<int32>(Pixel.B)));
+				Max = FIntVector(FMath::Max(Max.X, static_cast<int32>(Pixel.R)), FMath::Max(Max.Y, static_cast<int32>(Pixel.G)), FMath::Max(Max.Z, static_cast<int32>(Pixel.B)));
+			}
+			const FIntVector Inset = (Max - Min) / 16;
+			Min += Inset;
+			Max -= Inset;
+			
+			uint16 Color0 = To565(Max.X, Max.Y, Max.Z);
+			uint16 Color1 = To565(Min.X, Min.Y, Min.Z);
+			uint32 Indices = 0;
+			// Color0 must be the greater for the four color mode, a flat block keeps every index at 0
+			if (Color0 < Color1) {
+				Swap(Color0, Color1);
+			}
+			if (Color0 != Color1) {
+				const FIntVector C0 = From565(Color0), C1 = From565(Color1);
+				const FIntVector Palette[4] = {C0, C1, (C0 * 2 + C1) / 3, (C0 + C1 * 2) / 3};
+				for (int32 PixelIndex = 0; PixelIndex < 16; PixelIndex++) {
+					const FColor& Pixel = Block[PixelIndex];
+					int32 BestIndex = 0, BestDistance = MAX_int32;
+					for (int32 PaletteIndex = 0; PaletteIndex < 4; PaletteIndex++) {
+						const FIntVector Delta = Palette[PaletteIndex] - FIntVector(Pixel.R, Pixel.G, Pixel.B);
+						const int32 Distance = Delta.X * Delta.X + Delta.Y * Delta.Y + Delta.Z * Delta.Z;
+						if (Distance < BestDistance) {
+							BestDistance = Distance;
+							BestIndex = PaletteIndex;
+						}
+					}
+					Indices |= static_cast<uint32>(BestIndex) << (PixelIndex * 2);
+				}
+			}
+			
+			uint8* Output = OutBlocks + (static_cast<int64>(BlockY) * BlocksX + BlockX) * 8;
+			FMemory::Memcpy(Output, &Color0, 2);
+			FMemory::Memcpy(Output + 2, &Color1, 2);
+			FMemory::Memcpy(Output + 4, &Indices, 4);
+		}
+	});
+}
+
+/**
+ * Returns the size of an image block compressed by CompressBC1()
+ * @param Width Image width
+ * @param Height Image height
+ * @return The size in bytes, 8 per 4 x 4 block
+ */
+int64 FMyImageKernels::GetBC1Size(const int32 Width, const int32 Height) {
+	return static_cast<int64>(FMath::DivideAndRoundUp(Width, 4)) * FMath::DivideAndRoundUp(Height, 4) * 8;
+}
+
+/**
+ * Sorts pixels into a coarse RGB cube and sums the colors falling in each cell, the four channels of a pixel being
+ * added at once in a vector register
+ * @param Pixels Pixels to sort
+ * @param PixelCount Number of pixels
+ * @param LevelsPerChannel Cells along each channel, a power of two up to 256
+ * @param OutBinSums Sum of the B, G, R, A bytes of the pixels of each cell, indexed by (R * Levels + G) * Levels + B
+ * @param OutBinCounts Number of pixels of each cell
+ */
+void FMyImageKernels::BinColors(const FColor* Pixels, const int64 PixelCount, const int32 LevelsPerChannel, TArray<FVector4f>& OutBinSums, TArray<int32>& OutBinCounts) {
+	check(FMath::IsPowerOfTwo(LevelsPerChannel) && LevelsPerChannel <= 256);
+	const int32 BinCount = LevelsPerChannel * LevelsPerChannel * LevelsPerChannel;
+	const uint32 Shift = 8 - FMath::FloorLog2(LevelsPerChannel);
+	const uint32 LevelBits = 8 - Shift;
+	
+	TArray<VectorRegister4Float> Sums;
+	Sums.Init(VectorZeroFloat(), BinCount);
+	OutBinCounts.Init(0, BinCount);
+	for (int64 Index = 0; Index < PixelCount; Index++) {
+		const FColor& Pixel = Pixels[Index];
+		const int32 Bin = ((Pixel.R >> Shift) << LevelBits | Pixel.G >> Shift) << LevelBits | Pixel.B >> Shift;
+		Sums[Bin] = VectorAdd(Sums[Bin], VectorLoadByte4(&Pixel));
+		OutBinCounts[Bin]++;
+	}
+	
+	OutBinSums.SetNumUninitialized(BinCount);
+	for (int32 Bin = 0; Bin < BinCount; Bin++) {
+		VectorStore(Sums[Bin], &OutBinSums[Bin].X);
+	}
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Vectorised pixel kernels shared by the screenshot and tile import paths. They only touch the buffers they are given,
+ * so they are safe to call from worker threads
+ */
+class MDVPROJECT4_API FMyImageKernels {
+public:
+	static void BoxDownsample(const FColor* Source, int32 SourceWidth, int32 SourceHeight, int32 Factor, TArray<FColor>& OutPixels, int32& OutWidth, int32& OutHeight);
+
+	static int32 GetDownsampleFactor(int32 SourceWidth, int32 MaxWidth);
+
+	static uint64 ComputeDifferenceHash(const FColor* Pixels, int32 Width, int32 Height);
+
+	static void CompressBC1(const FColor* Pixels, int32 Width, int32 Height, uint8* OutBlocks);
+
+	static int64 GetBC1Size(int32 Width, int32 Height);
+
+	static void BinColors(const FColor* Pixels, int64 PixelCount, int32 LevelsPerChannel, TArray<FVector4f>& OutBinSums, TArray<int32>& OutBinCounts);
+};
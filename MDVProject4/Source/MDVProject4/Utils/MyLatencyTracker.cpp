@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyLatencyTracker.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "MyStats.h"
+
+static FAutoConsoleCommand DumpLatencyCommand(
+	TEXT("MDV.Latency.Dump"),
+	TEXT("Logs the click to pixels latency percentiles of the material applications"),
+	FConsoleCommandDelegate::CreateStatic(&FMyLatencyTracker::Dump));
+
+static FAutoConsoleCommand ResetLatencyCommand(
+	TEXT("MDV.Latency.Reset"),
+	TEXT("Discards the collected material application latencies"),
+	FConsoleCommandDelegate::CreateStatic(&FMyLatencyTracker::Reset));
+
+
+/**
+ * Starts measuring a material application, called when the user clicks a tile or the default button. The click stays
+ * pending until a material is set, so applications deferred by a load are measured end to end too
+ */
+void FMyLatencyTracker::MarkClick() {
+	check(IsInGameThread());
+	if (!bDelegatesRegistered) {
+		bDelegatesRegistered = true;
+		FCoreDelegates::OnEndFrameRT.AddStatic(&FMyLatencyTracker::OnEndFrameRenderThread);
+		FCoreDelegates::OnPreExit.AddStatic(&FMyLatencyTracker::Dump);
+	}
+	PendingClickTime = FPlatformTime::Seconds();
+}
+
+/**
+ * Called once the clicked material has been set on the selected walls
+ * @param bApplied False if no wall changed (empty selection or same material), which discards the pending click
+ */
+void FMyLatencyTracker::MarkMaterialSet(const bool bApplied) {
+	check(IsInGameThread());
+	if (PendingClickTime < 0.0) {
+		return;
+	}
+	if (bApplied) {
+		// The render thread renders this frame with the new material, GFrameNumber is its number on both threads
+		FScopeLock Lock(&SamplesLock);
+		PendingApplications.Add({PendingClickTime, FPlatformTime::Seconds(), GFrameNumber});
+	}
+	PendingClickTime = -1.0;
+}
+
+/**
+ * Completes the applications whose frame has just been rendered
+ */
+void FMyLatencyTracker::OnEndFrameRenderThread() {
+	FScopeLock Lock(&SamplesLock);
+	if (PendingApplications.IsEmpty()) {
+		return;
+	}
+	
+	const double Now = FPlatformTime::Seconds();
+	for (int32 Index = PendingApplications.Num() - 1; Index >= 0; Index--) {
+		const FMyPendingApplication& Application = PendingApplications[Index];
+		if (Application.Frame <= GFrameNumberRenderThread) {
+			ClickToSetTimes.Add((Application.SetTime - Application.ClickTime) * 1000.0);
+			SetToPixelsTimes.Add((Now - Application.SetTime) * 1000.0);
+			ClickToPixelsTimes.Add((Now - Application.ClickTime) * 1000.0);
+			PendingApplications.RemoveAtSwap(Index, 1, false);
+		}
+	}
+}
+
+/**
+ * Logs the percentiles and histograms of the collected latencies, in milliseconds
+ */
+void FMyLatencyTracker::Dump() {
+	TArray<double> ClickToSet, SetToPixels, ClickToPixels;
+	{
+		FScopeLock Lock(&SamplesLock);
+		ClickToSet = ClickToSetTimes;
+		SetToPixels = SetToPixelsTimes;
+		ClickToPixels = ClickToPixelsTimes;
+	}
+	if (ClickToPixels.IsEmpty()) {
+		UE_LOG(LogTemp, Display, TEXT("No material application latency has been measured"));
+		return;
+	}
+	
+	UE_LOG(LogTemp, Display, TEXT("Material application latency (ms):"));
+	UE_LOG(LogTemp, Display, TEXT("  %s"), *FString(FMyStats::TimingsCsvHeader).TrimEnd());
+	FString Csv;
+	FMyStats::ReportTimings(TEXT("ClickToSet"), MoveTemp(ClickToSet), Csv);
+	FMyStats::ReportTimings(TEXT("SetToPixels"), MoveTemp(SetToPixels), Csv);
+	FMyStats::ReportTimings(TEXT("ClickToPixels"), MoveTemp(ClickToPixels), Csv);
+}
+
+/**
+ * Discards the collected latencies
+ */
+void FMyLatencyTracker::Reset() {
+	FScopeLock Lock(&SamplesLock);
+	ClickToSetTimes.Reset();
+	SetToPixelsTimes.Reset();
+	ClickToPixelsTimes.Reset();
+}
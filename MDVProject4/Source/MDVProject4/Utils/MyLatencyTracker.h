@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Measures how long a material application takes to reach the screen: from the tile click, to the material being set
+ * on the selected walls, to the end of the first frame the render thread renders with it. "MDV.Latency.Dump" logs the
+ * percentiles and histograms, which are also written to the log when the application exits
+ */
+class MDVPROJECT4_API FMyLatencyTracker {
+public:
+	static void MarkClick();
+
+	static void MarkMaterialSet(bool bApplied);
+
+	static void Dump();
+
+	static void Reset();
+
+private:
+	struct FMyPendingApplication {
+		double ClickTime;
+		double SetTime;
+		uint32 Frame;
+	};
+
+	static void OnEndFrameRenderThread();
+
+	// Game thread only
+	static inline double PendingClickTime = -1.0;
+	static inline bool bDelegatesRegistered = false;
+
+	// Shared with the render thread
+	static inline FCriticalSection SamplesLock;
+	static inline TArray<FMyPendingApplication> PendingApplications;
+	static inline TArray<double> ClickToSetTimes;
+	static inline TArray<double> SetToPixelsTimes;
+	static inline TArray<double> ClickToPixelsTimes;
+};
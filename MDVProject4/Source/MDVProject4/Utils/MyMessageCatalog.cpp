@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyMessageCatalog.h"
+
+#include "Engine/DataTable.h"
+#include "Internationalization/Internationalization.h"
+
+FMyMessageCatalog::~FMyMessageCatalog() {
+	Shutdown();
+}
+
+/**
+ * Resolves every message of the table and keeps them up to date with the culture
+ * @param DataTable Table of FDataTableContent rows
+ */
+void FMyMessageCatalog::Initialise(const UDataTable* DataTable) {
+	MessageDataTable = DataTable;
+	Rebuild();
+	if (!CultureChangedHandle.IsValid()) {
+		CultureChangedHandle = FInternationalization::Get().OnCultureChanged().AddRaw(this, &FMyMessageCatalog::Rebuild);
+	}
+}
+
+void FMyMessageCatalog::Shutdown() {
+	if (CultureChangedHandle.IsValid()) {
+		FInternationalization::Get().OnCultureChanged().Remove(CultureChangedHandle);
+		CultureChangedHandle.Reset();
+	}
+}
+
+/**
+ * Fills the array with one message per EDataTableContentIndex entry, from the row named after the entry, and logs an
+ * error for each entry that has no row, which displays as an empty message
+ */
+void FMyMessageCatalog::Rebuild() {
+	Messages.Reset();
+	Messages.SetNum(DataTableContentCount);
+	
+	const UDataTable* DataTable = MessageDataTable.Get();
+	if (!DataTable) {
+		UE_LOG(LogTemp, Error, TEXT("The UI message table is missing, no message will be displayed"));
+		return;
+	}
+	
+	const UEnum* ContentIndexEnum = StaticEnum<EDataTableContentIndex>();
+	for (int32 Index = 0; Index < DataTableContentCount; Index++) {
+		const FString EntryName = ContentIndexEnum->GetNameStringByValue(Index);
+		if (const FDataTableContent* Row = DataTable->FindRow<FDataTableContent>(FName(EntryName), TEXT(""), false)) {
+			Messages[Index] = Row->Message;
+		} else {
+			UE_LOG(LogTemp, Error, TEXT("%s has no row named %s"), *DataTable->GetName(), *EntryName);
+		}
+	}
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DataStructures.h"
+
+class UDataTable;
+
+/**
+ * The UI messages of DT_UIMessages resolved once into an array indexed by EDataTableContentIndex. Rows are matched to
+ * the enum by name only, so the order of the rows does not matter. The catalog is rebuilt when the culture changes
+ */
+class MDVPROJECT4_API FMyMessageCatalog {
+public:
+	~FMyMessageCatalog();
+
+	void Initialise(const UDataTable* DataTable);
+
+	void Shutdown();
+
+	const FText& Get(const EDataTableContentIndex Index) const {
+		return Messages.IsValidIndex(Index) ? Messages[Index] : FText::GetEmpty();
+	}
+
+private:
+	void Rebuild();
+
+	TWeakObjectPtr<const UDataTable> MessageDataTable;
+
+	TArray<FText> Messages;
+
+	FDelegateHandle CultureChangedHandle;
+};
@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MyStats.h"
+
+#include "Engine/Texture.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "MDVProject4/Utils/DataStructures.h"
+
+DEFINE_STAT(STAT_MDV_InitialiseCatalog);
+DEFINE_STAT(STAT_MDV_ImportDecode);
+DEFINE_STAT(STAT_MDV_TextureCreation);
+DEFINE_STAT(STAT_MDV_MIDCreation);
+DEFINE_STAT(STAT_MDV_GridRebuild);
+DEFINE_STAT(STAT_MDV_WatcherEvents);
+DEFINE_STAT(STAT_MDV_SaveGame);
+DEFINE_STAT(STAT_MDV_LoadGame);
+DEFINE_STAT(STAT_MDV_ScreenshotEncode);
+DEFINE_STAT(STAT_MDV_TileSearch);
+DEFINE_STAT(STAT_MDV_ColorSearch);
+DEFINE_STAT(STAT_MDV_ScheduledWork);
+DEFINE_STAT(STAT_MDV_TextureUpload);
+
+DEFINE_STAT(STAT_MDV_TileCount);
+DEFINE_STAT(STAT_MDV_MIDCount);
+DEFINE_STAT(STAT_MDV_TileTextureMemory);
+DEFINE_STAT(STAT_MDV_SchedulerQueueDepth);
+DEFINE_STAT(STAT_MDV_SchedulerOverruns);
+DEFINE_STAT(STAT_MDV_TexturePoolHits);
+DEFINE_STAT(STAT_MDV_TexturePoolMisses);
+DEFINE_STAT(STAT_MDV_MaterialPoolHits);
+DEFINE_STAT(STAT_MDV_MaterialPoolMisses);
+DEFINE_STAT(STAT_MDV_TilePoolMemory);
+DEFINE_STAT(STAT_MDV_UploadQueueDepth);
+DEFINE_STAT(STAT_MDV_UploadPendingMemory);
+DEFINE_STAT(STAT_MDV_UploadedMemory);
+
+UE_TRACE_CHANNEL_DEFINE(MDVProject4Channel);
+
+TRACE_DECLARE_INT_COUNTER(MDV_TileCount, TEXT("MDVProject4/Tiles"));
+TRACE_DECLARE_INT_COUNTER(MDV_MIDCount, TEXT("MDVProject4/Material instances"));
+TRACE_DECLARE_MEMORY_COUNTER(MDV_TileTextureMemory, TEXT("MDVProject4/Tile textures"));
+TRACE_DECLARE_INT_COUNTER(MDV_SchedulerQueueDepth, TEXT("MDVProject4/Scheduler queue depth"));
+TRACE_DECLARE_INT_COUNTER(MDV_SchedulerOverruns, TEXT("MDVProject4/Scheduler budget overruns"));
+TRACE_DECLARE_INT_COUNTER(MDV_TexturePoolHits, TEXT("MDVProject4/Texture pool hits"));
+TRACE_DECLARE_INT_COUNTER(MDV_TexturePoolMisses, TEXT("MDVProject4/Texture pool misses"));
+TRACE_DECLARE_INT_COUNTER(MDV_MaterialPoolHits, TEXT("MDVProject4/Material pool hits"));
+TRACE_DECLARE_INT_COUNTER(MDV_MaterialPoolMisses, TEXT("MDVProject4/Material pool misses"));
+TRACE_DECLARE_MEMORY_COUNTER(MDV_TilePoolMemory, TEXT("MDVProject4/Pooled tile textures"));
+TRACE_DECLARE_INT_COUNTER(MDV_UploadQueueDepth, TEXT("MDVProject4/Upload queue depth"));
+TRACE_DECLARE_MEMORY_COUNTER(MDV_UploadPendingMemory, TEXT("MDVProject4/Uploads pending"));
+TRACE_DECLARE_MEMORY_COUNTER(MDV_UploadedMemory, TEXT("MDVProject4/Uploaded this frame"));
+
+
+/**
+ * Accounts for a tile added to the catalog, a tile set counting as one tile
+ * @param Tile Tile added, its textures and material may not be created yet
+ */
+void FMyStats::TileAdded(const FMyDynamicMat& Tile) {
+	const int64 TextureBytes = GetTileBytes(Tile);
+	
+	INC_DWORD_STAT(STAT_MDV_TileCount);
+	INC_MEMORY_STAT_BY(STAT_MDV_TileTextureMemory, TextureBytes);
+	TRACE_COUNTER_INCREMENT(MDV_TileCount);
+	TRACE_COUNTER_ADD(MDV_TileTextureMemory, TextureBytes);
+	
+	if (Tile.DynamicMaterial) {
+		INC_DWORD_STAT(STAT_MDV_MIDCount);
+		TRACE_COUNTER_INCREMENT(MDV_MIDCount);
+	}
+}
+
+/**
+ * Accounts for a tile removed from the catalog
+ * @param Tile Tile removed
+ */
+void FMyStats::TileRemoved(const FMyDynamicMat& Tile) {
+	const int64 TextureBytes = GetTileBytes(Tile);
+	
+	DEC_DWORD_STAT(STAT_MDV_TileCount);
+	DEC_MEMORY_STAT_BY(STAT_MDV_TileTextureMemory, TextureBytes);
+	TRACE_COUNTER_DECREMENT(MDV_TileCount);
+	TRACE_COUNTER_SUBTRACT(MDV_TileTextureMemory, TextureBytes);
+	
+	if (Tile.DynamicMaterial) {
+		DEC_DWORD_STAT(STAT_MDV_MIDCount);
+		TRACE_COUNTER_DECREMENT(MDV_MIDCount);
+	}
+}
+
+/**
+ * Accounts for the textures and material of a tile created after the tile was added, when it is first used
+ * @param Tile Tile loaded
+ */
+void FMyStats::TileLoaded(const FMyDynamicMat& Tile) {
+	const int64 TextureBytes = GetTileBytes(Tile);
+	
+	INC_MEMORY_STAT_BY(STAT_MDV_TileTextureMemory, TextureBytes);
+	TRACE_COUNTER_ADD(MDV_TileTextureMemory, TextureBytes);
+	
+	if (Tile.DynamicMaterial) {
+		INC_DWORD_STAT(STAT_MDV_MIDCount);
+		TRACE_COUNTER_INCREMENT(MDV_MIDCount);
+	}
+}
+
+/**
+ * Accounts for the textures of a tile uploaded after its creation: its full resolution texture replacing its preview,
+ * and its maps
+ * @param Tile Tile uploaded
+ * @param PreviewTexture Preview replaced, nullptr if the tile was created at full resolution
+ */
+void FMyStats::TileUploaded(const FMyDynamicMat& Tile, const UTexture* PreviewTexture) {
+	const int64 TextureBytes = GetTileBytes(Tile) - GetTextureBytes(PreviewTexture ? PreviewTexture : Tile.Texture2D);
+	
+	INC_MEMORY_STAT_BY(STAT_MDV_TileTextureMemory, TextureBytes);
+	TRACE_COUNTER_ADD(MDV_TileTextureMemory, TextureBytes);
+}
+
+/**
+ * Accounts for a frame of the frame scheduler
+ * @param QueueDepth Work items left in the queues after the frame
+ * @param bOverrun Whether the work of the frame took longer than its budget
+ */
+void FMyStats::SchedulerTicked(const int32 QueueDepth, const bool bOverrun) {
+	SET_DWORD_STAT(STAT_MDV_SchedulerQueueDepth, QueueDepth);
+	TRACE_COUNTER_SET(MDV_SchedulerQueueDepth, QueueDepth);
+	
+	if (bOverrun) {
+		INC_DWORD_STAT(STAT_MDV_SchedulerOverruns);
+		TRACE_COUNTER_INCREMENT(MDV_SchedulerOverruns);
+	}
+}
+
+/**
+ * Accounts for a texture requested from the tile pool
+ * @param bHit Whether a pooled texture was reused rather than a new one created
+ */
+void FMyStats::TexturePoolAcquired(const bool bHit) {
+	if (bHit) {
+		INC_DWORD_STAT(STAT_MDV_TexturePoolHits);
+		TRACE_COUNTER_INCREMENT(MDV_TexturePoolHits);
+	} else {
+		INC_DWORD_STAT(STAT_MDV_TexturePoolMisses);
+		TRACE_COUNTER_INCREMENT(MDV_TexturePoolMisses);
+	}
+}
+
+/**
+ * Accounts for a material instance requested from the tile pool
+ * @param bHit Whether a pooled material instance was reused rather than a new one created
+ */
+void FMyStats::MaterialPoolAcquired(const bool bHit) {
+	if (bHit) {
+		INC_DWORD_STAT(STAT_MDV_MaterialPoolHits);
+		TRACE_COUNTER_INCREMENT(MDV_MaterialPoolHits);
+	} else {
+		INC_DWORD_STAT(STAT_MDV_MaterialPoolMisses);
+		TRACE_COUNTER_INCREMENT(MDV_MaterialPoolMisses);
+	}
+}
+
+/**
+ * Accounts for textures entering or leaving the tile pool
+ * @param DeltaBytes Memory of the textures that entered, negative for the textures that left
+ */
+void FMyStats::TilePoolChanged(const int64 DeltaBytes) {
+	INC_MEMORY_STAT_BY(STAT_MDV_TilePoolMemory, DeltaBytes);
+	TRACE_COUNTER_ADD(MDV_TilePoolMemory, DeltaBytes);
+}
+
+/**
+ * Accounts for a frame of the texture uploader
+ * @param QueueDepth Uploads left after the frame
+ * @param PendingBytes Size of the uploads left
+ * @param UploadedBytes Size of the uploads of the frame
+ */
+void FMyStats::UploaderTicked(const int32 QueueDepth, const int64 PendingBytes, const int64 UploadedBytes) {
+	SET_DWORD_STAT(STAT_MDV_UploadQueueDepth, QueueDepth);
+	SET_MEMORY_STAT(STAT_MDV_UploadPendingMemory, PendingBytes);
+	SET_MEMORY_STAT(STAT_MDV_UploadedMemory, UploadedBytes);
+	TRACE_COUNTER_SET(MDV_UploadQueueDepth, QueueDepth);
+	TRACE_COUNTER_SET(MDV_UploadPendingMemory, PendingBytes);
+	TRACE_COUNTER_SET(MDV_UploadedMemory, UploadedBytes);
+}
+
+/**
+ * Returns the memory used by every mip of a texture
+ * @param Texture Texture to measure, may be nullptr
+ * @return The texture size in bytes, 0 for nullptr
+ */
+int64 FMyStats::GetTextureBytes(const UTexture* Texture) {
+	return Texture ? static_cast<int64>(Texture->CalcTextureMemorySizeEnum(TMC_AllMips)) : 0;
+}
+
+/**
+ * Returns the memory used by the textures of a tile: its albedo and the maps of its set
+ * @param Tile Tile to measure
+ * @return The size of the tile's textures in bytes
+ */
+int64 FMyStats::GetTileBytes(const FMyDynamicMat& Tile) {
+	return GetTextureBytes(Tile.Texture2D) + GetTextureBytes(Tile.NormalTexture) + GetTextureBytes(Tile.RoughnessTexture);
+}
+
+/**
+ * Logs the percentiles and the histogram of a series of timings and appends them to the CSV report
+ * @param Label Name of the series
+ * @param Timings Timings in milliseconds
+ * @param Csv CSV report
+ */
+void FMyStats::ReportTimings(const TCHAR* Label, TArray<double> Timings, FString& Csv) {
+	if (Timings.IsEmpty()) {
+		return;
+	}
+	Timings.Sort();
+	
+	auto Percentile = [&Timings](const double Fraction) {
+		return Timings[FMath::Min(static_cast<int32>(Fraction * Timings.Num()), Timings.Num() - 1)];
+	};
+	double Sum = 0.0;
+	int32 Buckets[8] = {};
+	for (const double Timing : Timings) {
+		Sum += Timing;
+		// Bucket upper bounds are 1, 2, 4, 8, 16, 33 and 66 ms
+		const int32 Bucket = Timing < 1.0 ? 0 : Timing < 2.0 ? 1 : Timing < 4.0 ? 2 : Timing < 8.0 ? 3
+			: Timing < 16.0 ? 4 : Timing < 33.0 ? 5 : Timing < 66.0 ? 6 : 7;
+		Buckets[Bucket]++;
+	}
+	
+	const FString Line = FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%d,%d,%d,%d,%d"),
+		Label, Timings.Num(), Sum / Timings.Num(), Percentile(0.5), Percentile(0.95), Percentile(0.99), Timings.Last(),
+		Buckets[0], Buckets[1], Buckets[2], Buckets[3], Buckets[4], Buckets[5], Buckets[6], Buckets[7]);
+	UE_LOG(LogTemp, Display, TEXT("  %s"), *Line);
+	Csv += Line + TEXT("\n");
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+class UTexture;
+struct FMyDynamicMat;
+
+// "stat MDVProject4" displays the group, and "-trace=cpu,MDVProject4" captures the channel in Unreal Insights
+DECLARE_STATS_GROUP(TEXT("MDVProject4"), STATGROUP_MDVProject4, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Catalog initialisation"), STAT_MDV_InitialiseCatalog, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import decode"), STAT_MDV_ImportDecode, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Texture creation"), STAT_MDV_TextureCreation, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MID creation"), STAT_MDV_MIDCreation, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grid rebuild"), STAT_MDV_GridRebuild, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Watcher events"), STAT_MDV_WatcherEvents, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Save game"), STAT_MDV_SaveGame, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load game"), STAT_MDV_LoadGame, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Screenshot encode"), STAT_MDV_ScreenshotEncode, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tile search"), STAT_MDV_TileSearch, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Color search"), STAT_MDV_ColorSearch, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Scheduled work"), STAT_MDV_ScheduledWork, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Texture upload"), STAT_MDV_TextureUpload, STATGROUP_MDVProject4, MDVPROJECT4_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Tiles"), STAT_MDV_TileCount, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Material instances"), STAT_MDV_MIDCount, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Tile textures"), STAT_MDV_TileTextureMemory, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Scheduler queue depth"), STAT_MDV_SchedulerQueueDepth, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Scheduler budget overruns"), STAT_MDV_SchedulerOverruns, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Texture pool hits"), STAT_MDV_TexturePoolHits, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Texture pool misses"), STAT_MDV_TexturePoolMisses, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Material pool hits"), STAT_MDV_MaterialPoolHits, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Material pool misses"), STAT_MDV_MaterialPoolMisses, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Pooled tile textures"), STAT_MDV_TilePoolMemory, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Upload queue depth"), STAT_MDV_UploadQueueDepth, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Uploads pending"), STAT_MDV_UploadPendingMemory, STATGROUP_MDVProject4, MDVPROJECT4_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Uploaded this frame"), STAT_MDV_UploadedMemory, STATGROUP_MDVProject4, MDVPROJECT4_API);
+
+UE_TRACE_CHANNEL_EXTERN(MDVProject4Channel, MDVPROJECT4_API);
+
+// Times the enclosing scope both in the stats system and as a CPU event of the MDVProject4 trace channel
+#define MDV_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Stat, MDVProject4Channel)
+
+/**
+ * Keeps the tile catalog counters of the stats group and their Insights counterparts in sync
+ */
+class MDVPROJECT4_API FMyStats {
+public:
+	static void TileAdded(const FMyDynamicMat& Tile);
+
+	static void TileRemoved(const FMyDynamicMat& Tile);
+
+	static void TileLoaded(const FMyDynamicMat& Tile);
+
+	static void TileUploaded(const FMyDynamicMat& Tile, const UTexture* PreviewTexture);
+
+	static void SchedulerTicked(int32 QueueDepth, bool bOverrun);
+
+	static void TexturePoolAcquired(bool bHit);
+
+	static void MaterialPoolAcquired(bool bHit);
+
+	static void TilePoolChanged(int64 DeltaBytes);
+
+	static void UploaderTicked(int32 QueueDepth, int64 PendingBytes, int64 UploadedBytes);
+
+	static void ReportTimings(const TCHAR* Label, TArray<double> Timings, FString& Csv);
+
+	// Header of the CSV lines written by ReportTimings()
+	static constexpr const TCHAR* TimingsCsvHeader = TEXT("Metric,Samples,Average,P50,P95,P99,Max,Under1ms,1-2ms,2-4ms,4-8ms,8-16ms,16-33ms,33-66ms,Over66ms\n");
+
+private:
+	static int64 GetTextureBytes(const UTexture* Texture);
+
+	static int64 GetTileBytes(const FMyDynamicMat& Tile);
+};
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileDuplicateIndex.h"
+
+
+/**
+ * Indexes a hash, replacing the hash previously indexed under the same id
+ * @param Id Caller's identifier of the hash
+ * @param Hash Perceptual hash
+ */
+void FMyTileDuplicateIndex::Add(const int32 Id, const uint64 Hash) {
+	Remove(Id);
+	Insert(Id, Hash);
+}
+
+/**
+ * Removes a hash from the index
+ * @param Id Identifier the hash was added with
+ */
+void FMyTileDuplicateIndex::Remove(const int32 Id) {
+	int32 NodeIndex;
+	if (!NodeIndices.RemoveAndCopyValue(Id, NodeIndex)) {
+		return;
+	}
+	Nodes[NodeIndex].bRemoved = true;
+	if (++RemovedCount * 2 > Nodes.Num()) {
+		Rebuild();
+	}
+}
+
+/**
+ * Empties the index
+ */
+void FMyTileDuplicateIndex::Reset() {
+	Nodes.Reset();
+	NodeIndices.Reset();
+	RemovedCount = 0;
+}
+
+/**
+ * Finds the hashes within a Hamming distance of a hash
+ * @param Hash Queried hash
+ * @param MaxDistance Maximum number of differing bits
+ * @param OutIds Ids of the hashes found, in no particular order
+ */
+void FMyTileDuplicateIndex::FindWithin(const uint64 Hash, const int32 MaxDistance, TArray<int32>& OutIds) const {
+	OutIds.Reset();
+	if (Nodes.IsEmpty()) {
+		return;
+	}
+	TArray<int32, TInlineAllocator<64>> PendingNodes;
+	PendingNodes.Add(0);
+	while (!PendingNodes.IsEmpty()) {
+		const FMyNode& Node = Nodes[PendingNodes.Pop(false)];
+		const int32 Distance = GetDistance(Node.Hash, Hash);
+		if (Distance <= MaxDistance && !Node.bRemoved) {
+			OutIds.Add(Node.Id);
+		}
+		for (const int32 Child : Node.Children) {
+			if (FMath::Abs(Nodes[Child].ParentDistance - Distance) <= MaxDistance) {
+				PendingNodes.Add(Child);
+			}
+		}
+	}
+}
+
+/**
+ * Adds a node for a hash below the first node at each level whose distance to the hash no child has yet
+ * @param Id Identifier of the hash
+ * @param Hash Perceptual hash
+ */
+void FMyTileDuplicateIndex::Insert(const int32 Id, const uint64 Hash) {
+	const int32 NewNodeIndex = Nodes.Add({Hash, Id, 0, false, {}});
+	NodeIndices.Add(Id, NewNodeIndex);
+	if (NewNodeIndex == 0) {
+		return;
+	}
+	
+	int32 NodeIndex = 0;
+	while (true) {
+		const int32 Distance = GetDistance(Nodes[NodeIndex].Hash, Hash);
+		const int32* Child = Nodes[NodeIndex].Children.FindByPredicate([this, Distance](const int32 ChildIndex) {
+			return Nodes[ChildIndex].ParentDistance == Distance;
+		});
+		if (!Child) {
+			Nodes[NewNodeIndex].ParentDistance = Distance;
+			Nodes[NodeIndex].Children.Add(NewNodeIndex);
+			return;
+		}
+		NodeIndex = *Child;
+	}
+}
+
+/**
+ * Rebuilds the tree from its live nodes, dropping the removed ones
+ */
+void FMyTileDuplicateIndex::Rebuild() {
+	TArray<FMyNode> PreviousNodes = MoveTemp(Nodes);
+	Reset();
+	for (const FMyNode& Node : PreviousNodes) {
+		if (!Node.bRemoved) {
+			Insert(Node.Id, Node.Hash);
+		}
+	}
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * BK-tree over 64 bit perceptual hashes, finding the hashes within a Hamming distance of a query without comparing it
+ * to every hash: each node sorts its children by their distance to it, so by the triangle inequality only the children
+ * whose distance is within the query radius of the query's distance to the node can hold matches.
+ * Removed hashes are only flagged, the tree is rebuilt once they make up half of it
+ */
+class MDVPROJECT4_API FMyTileDuplicateIndex {
+public:
+	void Add(int32 Id, uint64 Hash);
+
+	void Remove(int32 Id);
+
+	void Reset();
+
+	void FindWithin(uint64 Hash, int32 MaxDistance, TArray<int32>& OutIds) const;
+
+	static int32 GetDistance(const uint64 A, const uint64 B) { return static_cast<int32>(FMath::CountBits(A ^ B)); }
+
+private:
+	void Insert(int32 Id, uint64 Hash);
+
+	void Rebuild();
+
+	struct FMyNode {
+		uint64 Hash;
+		int32 Id;
+		// Distance to the parent node
+		int32 ParentDistance;
+		bool bRemoved;
+		TArray<int32> Children;
+	};
+
+	TArray<FMyNode> Nodes;
+
+	// Node of each live id
+	TMap<int32, int32> NodeIndices;
+
+	int32 RemovedCount = 0;
+};
@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileNameIndex.h"
+
+#include "Algo/BinarySearch.h"
+
+// Names sharing less than this proportion of trigrams with the query (Dice coefficient) are not considered
+static constexpr float MinTrigramSimilarity = 0.5f;
+// Number of best trigram candidates verified with the edit distance
+static constexpr int32 MaxVerifiedCandidates = 8;
+// Allowed edit distance, as a proportion of the query's length
+static constexpr float MaxEditDistanceRatio = 0.3f;
+
+
+/**
+ * Indexes a file name, replacing the name previously indexed under the same id
+ * @param Id Caller's identifier of the name
+ * @param FileName File name, with or without path and extension
+ * @param Keywords Additional words the name is found by in searches (ie. library root, categories)
+ */
+void FMyTileNameIndex::Add(const int32 Id, const FString& FileName, const TArray<FString>& Keywords) {
+	Remove(Id);
+	FMyIndexedName& IndexedName = Names.Add(Id);
+	IndexedName.NormalisedName = Normalise(FileName);
+	IndexedName.SearchText = IndexedName.NormalisedName;
+	for (const FString& Keyword : Keywords) {
+		IndexedName.SearchText += TEXT(" ") + NormaliseText(Keyword);
+	}
+	GetTrigrams(IndexedName.SearchText, IndexedName.Trigrams);
+	GetTrigrams(IndexedName.NormalisedName, IndexedName.NameTrigrams);
+	IndexedName.NameTrigrams.Sort();
+	for (const uint64 Trigram : IndexedName.Trigrams) {
+		Postings.FindOrAdd(Trigram).Add(Id);
+	}
+}
+
+/**
+ * Removes a name from the index
+ * @param Id Identifier the name was added with
+ */
+void FMyTileNameIndex::Remove(const int32 Id) {
+	FMyIndexedName IndexedName;
+	if (!Names.RemoveAndCopyValue(Id, IndexedName)) {
+		return;
+	}
+	for (const uint64 Trigram : IndexedName.Trigrams) {
+		if (TArray<int32>* Ids = Postings.Find(Trigram)) {
+			Ids->RemoveSingleSwap(Id, false);
+			if (Ids->IsEmpty()) {
+				Postings.Remove(Trigram);
+			}
+		}
+	}
+}
+
+void FMyTileNameIndex::Reset() {
+	Names.Reset();
+	Postings.Reset();
+}
+
+/**
+ * Finds the names containing every term of a query, anywhere in the name or its keywords, so prefixes and substrings
+ * both match. Terms of three characters or more are looked up in the trigram lists, shorter ones are only checked on
+ * the candidates
+ * @param Query Space separated terms
+ * @param OutIds Ids of the matching names, in increasing order
+ */
+void FMyTileNameIndex::Search(const FString& Query, TArray<int32>& OutIds) const {
+	OutIds.Reset();
+	TArray<FString> Terms;
+	NormaliseText(Query).ParseIntoArrayWS(Terms);
+	if (Terms.IsEmpty()) {
+		return;
+	}
+
+	// Start from the shortest trigram list of the query, every match must be in it
+	const TArray<int32>* ShortestList = nullptr;
+	for (const FString& Term : Terms) {
+		for (int32 Index = 0; Index + 2 < Term.Len(); Index++) {
+			const TArray<int32>* Ids = Postings.Find(PackTrigram(*Term + Index));
+			if (!Ids) {
+				return;
+			}
+			if (!ShortestList || Ids->Num() < ShortestList->Num()) {
+				ShortestList = Ids;
+			}
+		}
+	}
+	
+	auto Matches = [&Terms](const FMyIndexedName& IndexedName) {
+		for (const FString& Term : Terms) {
+			if (!IndexedName.SearchText.Contains(Term, ESearchCase::CaseSensitive)) {
+				return false;
+			}
+		}
+		return true;
+	};
+	if (ShortestList) {
+		for (const int32 Id : *ShortestList) {
+			if (Matches(Names[Id])) {
+				OutIds.Add(Id);
+			}
+		}
+	} else {
+		for (const TPair<int32, FMyIndexedName>& IndexedName : Names) {
+			if (Matches(IndexedName.Value)) {
+				OutIds.Add(IndexedName.Key);
+			}
+		}
+	}
+	OutIds.Sort();
+}
+
+/**
+ * Finds the indexed name closest to a file name
+ * @param FileName File name, with or without path and extension
+ * @return Id of the closest name, INDEX_NONE if no name is close enough
+ */
+int32 FMyTileNameIndex::FindClosest(const FString& FileName) const {
+	const FString Query = Normalise(FileName);
+	TArray<uint64> QueryTrigrams;
+	GetTrigrams(Query, QueryTrigrams);
+	if (QueryTrigrams.IsEmpty()) {
+		return INDEX_NONE;
+	}
+	
+	// Count the trigrams every name shares with the query, keywords included, which bounds the count of the name alone
+	TMap<int32, int32> SharedTrigrams;
+	for (const uint64 Trigram : QueryTrigrams) {
+		if (const TArray<int32>* Ids = Postings.Find(Trigram)) {
+			for (const int32 Id : *Ids) {
+				SharedTrigrams.FindOrAdd(Id)++;
+			}
+		}
+	}
+	
+	TArray<TPair<float, int32>> Candidates;
+	for (const TPair<int32, int32>& Shared : SharedTrigrams) {
+		const TArray<uint64>& NameTrigrams = Names[Shared.Key].NameTrigrams;
+		const int32 TrigramCount = QueryTrigrams.Num() + NameTrigrams.Num();
+		if (2.f * Shared.Value / TrigramCount < MinTrigramSimilarity) {
+			continue;
+		}
+		int32 SharedNameTrigrams = 0;
+		for (const uint64 Trigram : QueryTrigrams) {
+			if (Algo::BinarySearch(NameTrigrams, Trigram) != INDEX_NONE) {
+				SharedNameTrigrams++;
+			}
+		}
+		const float Similarity = 2.f * SharedNameTrigrams / TrigramCount;
+		if (Similarity >= MinTrigramSimilarity) {
+			Candidates.Emplace(Similarity, Shared.Key);
+		}
+	}
+	Candidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) {
+		return A.Key > B.Key;
+	});
+	
+	int32 BestId = INDEX_NONE;
+	int32 BestDistance = FMath::Max(1, FMath::FloorToInt32(Query.Len() * MaxEditDistanceRatio));
+	for (int32 Index = 0; Index < FMath::Min(Candidates.Num(), MaxVerifiedCandidates); Index++) {
+		const int32 Distance = GetBoundedEditDistance(Query, Names[Candidates[Index].Value].NormalisedName, BestDistance);
+		// Candidates are in decreasing similarity, so ties keep the most similar one
+		if (Distance < BestDistance || (Distance == BestDistance && BestId == INDEX_NONE)) {
+			BestDistance = Distance;
+			BestId = Candidates[Index].Value;
+		}
+	}
+	return BestId;
+}
+
+/**
+ * Lowercases a file name and replaces its separators with spaces, dropping its path and extension
+ * @param FileName File name
+ * @return The normalised name
+ */
+FString FMyTileNameIndex::Normalise(const FString& FileName) {
+	return NormaliseText(FPaths::GetBaseFilename(FileName));
+}
+
+/**
+ * Lowercases a text and replaces everything but letters and digits with spaces
+ * @param Text Text to normalise
+ * @return The normalised text
+ */
+FString FMyTileNameIndex::NormaliseText(const FString& Text) {
+	FString NormalisedText = Text.ToLower();
+	for (TCHAR& Character : NormalisedText) {
+		if (!FChar::IsAlnum(Character)) {
+			Character = TEXT(' ');
+		}
+	}
+	return NormalisedText;
+}
+
+/**
+ * Computes the Levenshtein distance between two strings, giving up once it is known to exceed MaxDistance
+ * @param A First string
+ * @param B Second string
+ * @param MaxDistance Largest distance of interest
+ * @return The distance, or MaxDistance + 1 if it is larger than MaxDistance
+ */
+int32 FMyTileNameIndex::GetBoundedEditDistance(const FString& A, const FString& B, const int32 MaxDistance) {
+	if (FMath::Abs(A.Len() - B.Len()) > MaxDistance) {
+		return MaxDistance + 1;
+	}
+	
+	TArray<int32, TInlineAllocator<64>> Previous, Current;
+	Previous.SetNumUninitialized(B.Len() + 1);
+	Current.SetNumUninitialized(B.Len() + 1);
+	for (int32 Column = 0; Column <= B.Len(); Column++) {
+		Previous[Column] = Column;
+	}
+	
+	for (int32 Row = 1; Row <= A.Len(); Row++) {
+		Current[0] = Row;
+		int32 RowMinimum = Row;
+		for (int32 Column = 1; Column <= B.Len(); Column++) {
+			const int32 Substitution = Previous[Column - 1] + (A[Row - 1] == B[Column - 1] ? 0 : 1);
+			Current[Column] = FMath::Min3(Previous[Column] + 1, Current[Column - 1] + 1, Substitution);
+			RowMinimum = FMath::Min(RowMinimum, Current[Column]);
+		}
+		// Distances never decrease from one row to the next
+		if (RowMinimum > MaxDistance) {
+			return MaxDistance + 1;
+		}
+		Swap(Previous, Current);
+	}
+	return FMath::Min(Previous[B.Len()], MaxDistance + 1);
+}
+
+/**
+ * Extracts the distinct trigrams of a normalised text, padded with spaces so its first and last characters count
+ * @param NormalisedText Text returned by Normalise() or NormaliseText()
+ * @param OutTrigrams Trigrams packed by PackTrigram()
+ */
+void FMyTileNameIndex::GetTrigrams(const FString& NormalisedText, TArray<uint64>& OutTrigrams) {
+	OutTrigrams.Reset();
+	const FString Padded = TEXT(" ") + NormalisedText + TEXT(" ");
+	for (int32 Index = 0; Index + 2 < Padded.Len(); Index++) {
+		OutTrigrams.AddUnique(PackTrigram(*Padded + Index));
+	}
+}
+
+/**
+ * Packs three UTF-16 characters in a 64 bit integer
+ * @param Characters First of the three characters
+ * @return The packed trigram
+ */
+uint64 FMyTileNameIndex::PackTrigram(const TCHAR* Characters) {
+	return static_cast<uint64>(static_cast<uint16>(Characters[0])) << 32
+		| static_cast<uint64>(static_cast<uint16>(Characters[1])) << 16
+		| static_cast<uint64>(static_cast<uint16>(Characters[2]));
+}
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Trigram index over tile file names and keywords (path segments, categories), maintained incrementally. Names are
+ * compared without extension, case or separators ("Oak_Floor-02.png" and "oak floor 02.jpg" are the same name).
+ * - Search() returns the tiles containing every term of a query, by intersecting the trigram lists of its terms
+ * - FindClosest() returns the tile a renamed or moved file most likely became: candidates sharing the most trigrams
+ *   with the file name, keywords left out, are verified with an edit distance that gives up as soon as it exceeds the allowed distance
+ */
+class MDVPROJECT4_API FMyTileNameIndex {
+public:
+	void Add(int32 Id, const FString& FileName, const TArray<FString>& Keywords = TArray<FString>());
+
+	void Remove(int32 Id);
+
+	void Reset();
+
+	bool IsEmpty() const { return Names.IsEmpty(); }
+
+	void Search(const FString& Query, TArray<int32>& OutIds) const;
+
+	int32 FindClosest(const FString& FileName) const;
+
+	static FString Normalise(const FString& FileName);
+
+	static FString NormaliseText(const FString& Text);
+
+	static int32 GetBoundedEditDistance(const FString& A, const FString& B, int32 MaxDistance);
+
+private:
+	static void GetTrigrams(const FString& NormalisedText, TArray<uint64>& OutTrigrams);
+
+	static uint64 PackTrigram(const TCHAR* Characters);
+
+	struct FMyIndexedName {
+		FString NormalisedName;
+		// Normalised name and keywords separated by spaces
+		FString SearchText;
+		TArray<uint64> Trigrams;
+		// Trigrams of the normalised name alone, sorted, which FindClosest() compares names by
+		TArray<uint64> NameTrigrams;
+	};
+
+	TMap<int32, FMyIndexedName> Names;
+
+	// Ids of the names containing each trigram
+	TMap<uint64, TArray<int32>> Postings;
+};
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileSetNaming.h"
+
+// Suffixes of each map, longest first so "_nrm" is not read as "_n"
+static const TCHAR* AlbedoSuffixes[] = {TEXT("_basecolour"), TEXT("_basecolor"), TEXT("_diffuse"), TEXT("_albedo"), TEXT("_color"), TEXT("_col")};
+static const TCHAR* NormalSuffixes[] = {TEXT("_normal"), TEXT("_nrm"), TEXT("_nor"), TEXT("_n")};
+static const TCHAR* RoughnessSuffixes[] = {TEXT("_roughness"), TEXT("_rough"), TEXT("_orm"), TEXT("_arm"), TEXT("_rao"), TEXT("_r")};
+
+
+/**
+ * Returns which map of its set an image file is
+ * @param FileName File name, with or without path and extension
+ * @param OutSetName Name of the set, the file's base name without its map suffix
+ * @return The map, Albedo for a file without map suffix
+ */
+FMyTileSetNaming::EMap FMyTileSetNaming::GetMap(const FString& FileName, FString& OutSetName) {
+	OutSetName = FPaths::GetBaseFilename(FileName);
+	const auto RemoveSuffix = [&OutSetName](const TArrayView<const TCHAR* const> Suffixes) {
+		for (const TCHAR* Suffix : Suffixes) {
+			if (OutSetName.Len() > FCString::Strlen(Suffix) && OutSetName.EndsWith(Suffix, ESearchCase::IgnoreCase)) {
+				OutSetName.LeftChopInline(FCString::Strlen(Suffix));
+				return true;
+			}
+		}
+		return false;
+	};
+	
+	if (RemoveSuffix(NormalSuffixes)) {
+		return EMap::Normal;
+	}
+	if (RemoveSuffix(RoughnessSuffixes)) {
+		return EMap::Roughness;
+	}
+	RemoveSuffix(AlbedoSuffixes);
+	return EMap::Albedo;
+}
+
+/**
+ * Groups the image files of a directory into tile sets, in the order their albedo is listed
+ * @param Directory Directory of the files, ending with a slash
+ * @param FileNames Clean file names of the images
+ * @return The tile sets, with full paths
+ */
+TArray<FMyTileSetFiles> FMyTileSetNaming::Group(const FString& Directory, const TArray<FString>& FileNames) {
+	TArray<FMyTileSetFiles> TileSets;
+	TMap<FString, int32> SetIndices;
+	TArray<TPair<FString, EMap>> Maps;
+	
+	// Albedos first, so the maps listed before their albedo still find their set
+	for (const FString& FileName : FileNames) {
+		FString SetName;
+		const EMap Map = GetMap(FileName, SetName);
+		SetName.ToLowerInline();
+		if (Map != EMap::Albedo) {
+			Maps.Emplace(FileName, Map);
+		} else if (SetIndices.Contains(SetName)) {
+			// Another albedo of the same set (ie. "Oak.png" and "Oak.jpg") is a tile of its own
+			TileSets.AddDefaulted_GetRef().AlbedoPath = Directory + FileName;
+		} else {
+			SetIndices.Add(SetName, TileSets.Num());
+			TileSets.AddDefaulted_GetRef().AlbedoPath = Directory + FileName;
+		}
+	}
+	
+	for (const TPair<FString, EMap>& Map : Maps) {
+		FString SetName;
+		GetMap(Map.Key, SetName);
+		const int32* SetIndex = SetIndices.Find(SetName.ToLower());
+		FString* MapPath = nullptr;
+		if (SetIndex) {
+			MapPath = Map.Value == EMap::Normal ? &TileSets[*SetIndex].NormalPath : &TileSets[*SetIndex].RoughnessPath;
+		}
+		if (MapPath && MapPath->IsEmpty()) {
+			*MapPath = Directory + Map.Key;
+		} else {
+			TileSets.AddDefaulted_GetRef().AlbedoPath = Directory + Map.Key;
+		}
+	}
+	return TileSets;
+}
+
+/**
+ * Lists the directory of an image file to find the tile set it belongs to, used when a single file changes
+ * @param FilePath Full path of the file
+ * @return The tile set of the file, made of the file alone if it is not in the directory anymore
+ */
+FMyTileSetFiles FMyTileSetNaming::FindSet(const FString& FilePath) {
+	const FString Directory = FPaths::GetPath(FilePath) / TEXT("");
+	TArray<FString> FileNames;
+	IFileManager& FileManager = IFileManager::Get();
+	FileManager.FindFiles(FileNames, *Directory, *FString("png"));
+	FileManager.FindFiles(FileNames, *Directory, *FString("jpg"));
+	FileManager.FindFiles(FileNames, *Directory, *FString("jpeg"));
+	
+	for (FMyTileSetFiles& TileSet : Group(Directory, FileNames)) {
+		if (TileSet.Contains(FilePath)) {
+			return MoveTemp(TileSet);
+		}
+	}
+	FMyTileSetFiles TileSet;
+	TileSet.AlbedoPath = FilePath;
+	return TileSet;
+}
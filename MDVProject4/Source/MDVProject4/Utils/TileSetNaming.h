@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Image files of a tile set: its albedo, which the tile is named after, and the maps shipped with it, empty if missing
+struct FMyTileSetFiles {
+	FString AlbedoPath;
+	FString NormalPath;
+	FString RoughnessPath;
+
+	bool HasMaps() const { return !NormalPath.IsEmpty() || !RoughnessPath.IsEmpty(); }
+
+	bool Contains(const FString& FilePath) const {
+		return AlbedoPath == FilePath || NormalPath == FilePath || RoughnessPath == FilePath;
+	}
+};
+
+/**
+ * Recognises the maps of tile sets by the suffix of their file names: "Oak.png" or "Oak_Albedo.png" is the albedo of the
+ * set "Oak", "Oak_Normal.png" its normal map and "Oak_ORM.png" its roughness/AO map. Suffixes are matched regardless
+ * of case. A map whose set has no albedo is kept as a tile of its own
+ */
+class MDVPROJECT4_API FMyTileSetNaming {
+public:
+	enum class EMap : uint8 {
+		Albedo,
+		Normal,
+		Roughness
+	};
+
+	static EMap GetMap(const FString& FileName, FString& OutSetName);
+
+	static TArray<FMyTileSetFiles> Group(const FString& Directory, const TArray<FString>& FileNames);
+
+	static FMyTileSetFiles FindSet(const FString& FilePath);
+};